@@ -7,7 +7,9 @@ echo.
 
 echo [1/3] 编译词法分析器...
 cd lexical_analyzer
-gcc scanner.c main.c -o lexer.exe
+gcc gen_lexer.c -o gen_lexer.exe
+gen_lexer.exe tokens.spec .
+gcc scanner.c scan_simd.c unicode.c intern.c literal.c main.c -o lexer.exe -lpthread
 if exist lexer.exe (
     echo 词法分析器编译完成！
 ) else (
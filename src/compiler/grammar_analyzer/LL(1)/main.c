@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "parser.h"
 
-int main() {
+// 用法: ll1_parser [-p]
+//   -p  流水线模式：词法分析在单独的线程中进行，边分析边把Token交给语法分析
+int main(int argc, char* argv[]) {
     printf("========================================\n");
     printf("      实验三：LL(1)语法分析器\n");
     printf("========================================\n\n");
@@ -10,6 +13,7 @@ int main() {
     const char* grammar_file = "grammar.txt";
     const char* input_file = "input.txt";
     const char* output_file = "ll1_result.txt";
+    int pipelined = argc > 1 && (strcmp(argv[1], "-p") == 0 || strcmp(argv[1], "--pipeline") == 0);
     
     printf("文法文件: %s\n", grammar_file);
     printf("输入文件: %s\n", input_file);
@@ -32,7 +36,7 @@ int main() {
     print_analysis_table();
     
     // 执行语法分析
-    parse_input(input_file);
+    parse_input(input_file, pipelined);
     
     // 显示分析过程
     display_ll1_process();
@@ -483,19 +483,23 @@ void print_analysis_table() {
 }
 
 // 执行LL(1)分析
-void parse_input(const char* input_filename) {
-    printf("\n开始LL(1)语法分析...\n");
-    
-    // 打开输入文件
-    FILE* input = fopen(input_filename, "r");
-    if (!input) {
+void parse_input(const char* input_filename, int pipelined) {
+    printf("\n开始LL(1)语法分析%s...\n", pipelined ? "（流水线模式）" : "");
+    
+    // 一次性完成整个文件的词法分析（源文件没有变化时直接加载Token缓存），之后按下标读取Token；
+    // 流水线模式下词法分析在单独的线程中进行，Token逐个从pipe中取出
+    TokenStream* tokens = NULL;
+    TokenPipe* pipe = NULL;
+    int cache_hit = 0;
+    if (pipelined) pipe = token_pipe_open(input_filename);
+    else tokens = tokenize_file_cached(input_filename, 1, &cache_hit);
+    if (!tokens && !pipe) {
         printf("错误：无法打开输入文件 %s\n", input_filename);
         exit(1);
     }
-    
-    // 初始化词法分析器
-    init_scanner(input);
-    current_token = get_next_token();
+    if (cache_hit) printf("使用Token缓存 %s%s\n", input_filename, TOKEN_CACHE_SUFFIX);
+    uint32_t token_index = 0;
+    current_token = pipe ? token_pipe_next(pipe) : token_stream_get(tokens, token_index);
     
     // 分析栈
     char* stack[MAX_STACK_SIZE];
@@ -524,9 +528,11 @@ void parse_input(const char* input_filename) {
         // 构建输入字符串
         char input_buf[200] = "";
         strcpy(input_buf, input_symbol);
-        if (current_token.lexeme[0] != '\0') {
+        if (pipe) scanner_token_text(token_pipe_scanner(pipe), current_token, input_str, sizeof(input_str));
+        else token_stream_text(tokens, token_index, input_str, sizeof(input_str));
+        if (input_str[0] != '\0') {
             strcat(input_buf, " ");
-            strcat(input_buf, current_token.lexeme);
+            strcat(input_buf, input_str);
         }
         strcat(input_buf, " ...");
         
@@ -551,7 +557,7 @@ void parse_input(const char* input_filename) {
                 
                 // 获取下一个输入符号
                 if (current_token.type != TK_EOF) {
-                    current_token = get_next_token();
+                    current_token = pipe ? token_pipe_next(pipe) : token_stream_get(tokens, ++token_index);
                     input_symbol = token_to_symbol(current_token.type);
                 } else {
                     input_symbol = "$";
@@ -615,6 +621,8 @@ void parse_input(const char* input_filename) {
                     for (int i = prod->right_count - 1; i >= 0; i--) {
                         if (top >= MAX_STACK_SIZE) {
                             printf("❌ 错误：分析栈溢出\n");
+                            token_stream_destroy(tokens);
+                            token_pipe_close(pipe);
                             return;
                         }
                         stack[top++] = prod->right[i];
@@ -629,9 +637,9 @@ void parse_input(const char* input_filename) {
         }
     }
     
-    // 关闭文件
-    close_scanner();
-    fclose(input);
+    // 释放词法分析结果（流水线模式下同时停止词法分析线程）
+    token_stream_destroy(tokens);
+    token_pipe_close(pipe);
     
     printf("LL(1)分析完成\n");
 }
@@ -2,6 +2,9 @@
 #define LL1_PARSER_H
 
 #include "../../lexical_analyzer/scanner.h"
+#include "../../lexical_analyzer/token_stream.h"
+#include "../../lexical_analyzer/token_cache.h"
+#include "../../lexical_analyzer/token_pipe.h"
 
 #define MAX_STACK_SIZE 100
 #define MAX_STEPS 500
@@ -52,7 +55,7 @@ void load_grammar(const char* filename);
 void build_first_sets();
 void build_follow_sets();
 void build_ll1_table();
-void parse_input(const char* input_filename);
+void parse_input(const char* input_filename, int pipelined);   // pipelined: 词法分析在单独的线程中进行
 void display_ll1_process();
 void save_ll1_result(const char* filename);
 void print_analysis_table();
@@ -0,0 +1,228 @@
+#include "ast.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AST_INITIAL_CAPACITY 1024
+
+// 创建空树
+Ast* ast_create() {
+    Ast* ast = (Ast*)calloc(1, sizeof(Ast));
+    if (!ast) return NULL;
+    ast->count = 1;     // 0号不用
+    return ast;
+}
+
+// 作废所有节点，保留数组
+void ast_reset(Ast* ast) {
+    ast->count = 1;
+}
+
+void ast_destroy(Ast* ast) {
+    if (!ast) return;
+    free(ast->kinds);
+    free(ast->payloads);
+    free(ast->lefts);
+    free(ast->rights);
+    free(ast->nexts);
+    free(ast->lines);
+    free(ast->columns);
+    free(ast);
+}
+
+// 扩大一个数组（失败时原数组保持不变）
+static int grow_array(void** array, size_t element_size, uint32_t capacity) {
+    void* grown = realloc(*array, (size_t)capacity * element_size);
+    if (!grown) return 0;
+    *array = grown;
+    return 1;
+}
+
+// 所有数组的容量加倍
+static int grow(Ast* ast) {
+    uint32_t capacity = ast->capacity ? ast->capacity * 2 : AST_INITIAL_CAPACITY;
+    if (!grow_array((void**)&ast->kinds, sizeof(uint8_t), capacity) ||
+        !grow_array((void**)&ast->payloads, sizeof(AstPayload), capacity) ||
+        !grow_array((void**)&ast->lefts, sizeof(AstId), capacity) ||
+        !grow_array((void**)&ast->rights, sizeof(AstId), capacity) ||
+        !grow_array((void**)&ast->nexts, sizeof(AstId), capacity) ||
+        !grow_array((void**)&ast->lines, sizeof(uint32_t), capacity) ||
+        !grow_array((void**)&ast->columns, sizeof(uint32_t), capacity)) {
+        return 0;
+    }
+    ast->capacity = capacity;
+    return 1;
+}
+
+// 添加节点
+AstId ast_add(Ast* ast, NodeType kind, int line, int column) {
+    if (ast->count >= ast->capacity && !grow(ast)) return AST_NONE;
+    
+    AstId id = ast->count++;
+    ast->kinds[id] = (uint8_t)kind;
+    ast->payloads[id].name = 0;
+    ast->lefts[id] = AST_NONE;
+    ast->rights[id] = AST_NONE;
+    ast->nexts[id] = AST_NONE;
+    ast->lines[id] = (uint32_t)line;
+    ast->columns[id] = (uint32_t)column;
+    return id;
+}
+
+// 节点个数
+uint32_t ast_node_count(const Ast* ast) {
+    return ast->count - 1;
+}
+
+// 已分配的数组占用的字节数
+size_t ast_memory(const Ast* ast) {
+    size_t per_node = sizeof(uint8_t) + sizeof(AstPayload) + 3 * sizeof(AstId) + 2 * sizeof(uint32_t);
+    return sizeof(Ast) + (size_t)ast->capacity * per_node;
+}
+
+// 节点类型名
+const char* ast_kind_name(NodeType kind) {
+    switch (kind) {
+        case NODE_PROGRAM: return "Program";
+        case NODE_BLOCK: return "Block";
+        case NODE_STATEMENT: return "Statement";
+        case NODE_ASSIGNMENT: return "Assignment";
+        case NODE_IF: return "If";
+        case NODE_WHILE: return "While";
+        case NODE_EXPRESSION: return "Expression";
+        case NODE_TERM: return "Term";
+        case NODE_FACTOR: return "Factor";
+        case NODE_ID: return "ID";
+        case NODE_NUM: return "NUM";
+        case NODE_STR: return "STRING";
+        case NODE_BINARY_OP: return "BinaryOp";
+        case NODE_CONDITION: return "Condition";
+        case NODE_RELOP: return "RelOp";
+        case NODE_ERROR: return "Error";
+        default: return "Unknown";
+    }
+}
+
+// 运算符文本
+const char* ast_op_text(AstOp op) {
+    switch (op) {
+        case OP_ADD: return "+";
+        case OP_SUB: return "-";
+        case OP_MUL: return "*";
+        case OP_DIV: return "/";
+        case OP_GT: return ">";
+        case OP_LT: return "<";
+        case OP_GE: return ">=";
+        case OP_LE: return "<=";
+        case OP_EQ: return "==";
+        case OP_NE: return "!=";
+        default: return "??";
+    }
+}
+
+// 运算符文本对应的运算符
+AstOp ast_op_from_text(const char* text) {
+    for (int op = OP_ADD; op <= OP_NE; op++) {
+        if (strcmp(text, ast_op_text((AstOp)op)) == 0) return (AstOp)op;
+    }
+    return OP_NONE;
+}
+
+// 是否是关系运算符
+int ast_op_is_relational(AstOp op) {
+    return op >= OP_GT && op <= OP_NE;
+}
+
+// 数字的文本：小数取能原样读回的最短写法，并且总带小数点
+static const char* number_text(NumLiteral number, char* buffer, size_t size) {
+    if (number.kind == NUM_INT) {
+        snprintf(buffer, size, "%lld", (long long)number.int_value);
+        return buffer;
+    }
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(buffer, size, "%.*g", precision, number.float_value);
+        if (strtod(buffer, NULL) == number.float_value) break;
+    }
+    if (!strpbrk(buffer, ".e") && strlen(buffer) + 2 < size) strcat(buffer, ".0");
+    return buffer;
+}
+
+// 节点的显示文本
+const char* ast_node_text(const Ast* ast, AstId node, char* buffer, size_t size) {
+    AstPayload payload = ast->payloads[node];
+    switch ((NodeType)ast->kinds[node]) {
+        case NODE_PROGRAM: return "program";
+        case NODE_BLOCK: return "block";
+        case NODE_IF: return payload.has_else ? "if-else" : "if";
+        case NODE_WHILE: return "while";
+        case NODE_CONDITION: return "condition";
+        case NODE_ID:
+        case NODE_STR:
+        case NODE_ASSIGNMENT:
+            return payload.name != INTERN_NONE ? intern_text(payload.name) : "";
+        case NODE_NUM: return number_text(literal_get(payload.literal), buffer, size);
+        case NODE_BINARY_OP:
+        case NODE_RELOP:
+            return ast_op_text((AstOp)payload.op);
+        default: return "";
+    }
+}
+
+// 缩进的最大层数：更深的节点按这一层缩进，并在前面标出实际层数，
+// 避免很深的表达式树（如上万项的连加）让输出按层数的平方增长
+#define AST_WRITE_MAX_INDENT 32
+
+typedef struct {
+    AstId node;
+    uint32_t depth;
+} AstWriteEntry;
+
+// 按缩进格式输出语句序列。用显式栈代替递归，很深的表达式树和很长的语句序列都不会耗尽调用栈：
+// 弹出一个节点输出后，依次压入它的兄弟、右孩子、左孩子，保证先输出左子树、再右子树、最后兄弟
+void ast_write(const Ast* ast, AstId node, int depth, FILE* out) {
+    if (node == AST_NONE) return;
+    
+    char buffer[64];
+    uint32_t capacity = 64;
+    uint32_t count = 0;
+    AstWriteEntry* stack = (AstWriteEntry*)malloc(capacity * sizeof(AstWriteEntry));
+    if (!stack) {
+        fprintf(out, "（内存不足，无法输出语法树）\n");
+        return;
+    }
+    stack[count++] = (AstWriteEntry){ node, (uint32_t)depth };
+    
+    while (count > 0) {
+        AstWriteEntry entry = stack[--count];
+        node = entry.node;
+    
+        uint32_t indent = entry.depth < AST_WRITE_MAX_INDENT ? entry.depth : AST_WRITE_MAX_INDENT;
+        for (uint32_t i = 0; i < indent; i++) fprintf(out, "  ");
+        if (entry.depth > AST_WRITE_MAX_INDENT) fprintf(out, "[%u] ", entry.depth);
+    
+        const char* type_str = ast_kind_name((NodeType)ast->kinds[node]);
+        const char* value = ast_node_text(ast, node, buffer, sizeof(buffer));
+        if (value[0] != '\0') {
+            fprintf(out, "%s: %s", type_str, value);
+            if (ast->lines[node] > 0) fprintf(out, " (行:%u)", ast->lines[node]);
+            fprintf(out, "\n");
+        } else {
+            fprintf(out, "%s\n", type_str);
+        }
+    
+        // 每次最多压入3项
+        if (capacity - count < 3) {
+            AstWriteEntry* grown = (AstWriteEntry*)realloc(stack, (size_t)capacity * 2 * sizeof(AstWriteEntry));
+            if (!grown) {
+                fprintf(out, "（内存不足，语法树未输出完）\n");
+                break;
+            }
+            stack = grown;
+            capacity *= 2;
+        }
+        if (ast->nexts[node] != AST_NONE) stack[count++] = (AstWriteEntry){ ast->nexts[node], entry.depth };
+        if (ast->rights[node] != AST_NONE) stack[count++] = (AstWriteEntry){ ast->rights[node], entry.depth + 1 };
+        if (ast->lefts[node] != AST_NONE) stack[count++] = (AstWriteEntry){ ast->lefts[node], entry.depth + 1 };
+    }
+    
+    free(stack);
+}
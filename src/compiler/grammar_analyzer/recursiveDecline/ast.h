@@ -0,0 +1,97 @@
+#ifndef AST_H
+#define AST_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../lexical_analyzer/intern.h"
+#include "../../lexical_analyzer/literal.h"
+
+// 扁平语法树：所有节点按编号存放在几个连续数组中（每个字段一个数组），
+// 孩子和兄弟用32位编号表示，节点的值按类型存放在4字节的payload中：
+// 名字存驻留编号，数字存字面量表编号，运算符存AstOp。
+// 编号从1开始，0表示没有节点。整棵树随Ast一起释放，重置后数组留给下一次分析使用。
+
+typedef uint32_t AstId;
+
+#define AST_NONE 0
+
+// 语法树节点类型
+typedef enum {
+    NODE_PROGRAM,
+    NODE_BLOCK,
+    NODE_STATEMENT,
+    NODE_ASSIGNMENT,
+    NODE_IF,
+    NODE_WHILE,
+    NODE_EXPRESSION,
+    NODE_TERM,
+    NODE_FACTOR,
+    NODE_ID,
+    NODE_NUM,
+    NODE_STR,
+    NODE_BINARY_OP,
+    NODE_CONDITION,
+    NODE_RELOP,
+    NODE_ERROR          // 语法错误处（缺少的因子或无法识别的语句）
+} NodeType;
+
+// 运算符
+typedef enum {
+    OP_NONE,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+    OP_GT, OP_LT, OP_GE, OP_LE, OP_EQ, OP_NE
+} AstOp;
+
+// 节点的值
+typedef union {
+    uint32_t name;          // ID、STR、ASSIGNMENT：驻留编号
+    uint32_t literal;       // NUM：字面量表编号
+    uint32_t op;            // BINARY_OP、RELOP：AstOp
+    uint32_t has_else;      // IF：是否是if-else节点（左孩子是不带else的if节点）
+} AstPayload;
+
+typedef struct {
+    uint8_t* kinds;         // NodeType
+    AstPayload* payloads;
+    AstId* lefts;
+    AstId* rights;
+    AstId* nexts;           // 下一个兄弟（语句序列）
+    uint32_t* lines;
+    uint32_t* columns;
+    uint32_t count;         // 已用的编号数（包括不用的0号）
+    uint32_t capacity;
+} Ast;
+
+// 创建空树，内存不足时返回NULL
+Ast* ast_create();
+
+// 作废所有节点，保留数组
+void ast_reset(Ast* ast);
+
+void ast_destroy(Ast* ast);
+
+// 添加节点（值为0，没有孩子和兄弟），内存不足时返回AST_NONE
+AstId ast_add(Ast* ast, NodeType kind, int line, int column);
+
+// 节点个数和占用的字节数
+uint32_t ast_node_count(const Ast* ast);
+size_t ast_memory(const Ast* ast);
+
+// 节点类型名（如"BinaryOp"）和运算符文本（如"+"）
+const char* ast_kind_name(NodeType kind);
+const char* ast_op_text(AstOp op);
+
+// 运算符文本对应的运算符，不认识时返回OP_NONE
+AstOp ast_op_from_text(const char* text);
+
+// 是否是关系运算符
+int ast_op_is_relational(AstOp op);
+
+// 节点的显示文本（名字、数字、运算符或"if"这样的固定文本），没有时为空串
+const char* ast_node_text(const Ast* ast, AstId node, char* buffer, size_t size);
+
+// 按缩进格式输出以node开头的语句序列及其子树（超过32层的节点不再加深缩进，行首标出实际层数）
+void ast_write(const Ast* ast, AstId node, int depth, FILE* out);
+
+#endif
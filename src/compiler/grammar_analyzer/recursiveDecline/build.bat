@@ -12,15 +12,24 @@ if exist analysis_result.txt del analysis_result.txt
 
 echo [2/5] 编译词法分析器...
 gcc -c ../../lexical_analyzer/scanner.c -o scanner.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/scan_simd.c -o scan_simd.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/token_stream.c -o token_stream.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/token_cache.c -o token_cache.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/token_pipe.c -o token_pipe.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/intern.c -o intern.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/literal.c -o literal.o -I../../lexical_analyzer
+gcc -c ../../lexical_analyzer/unicode.c -o unicode.o -I../../lexical_analyzer
 
 echo [3/5] 编译语法分析器...
+gcc -c ast.c -o ast.o -I../../lexical_analyzer
+gcc -c trace.c -o trace.o -I../../lexical_analyzer
 gcc -c parser.c -o parser.o -I../../lexical_analyzer
 
 echo [4/5] 编译主程序...
 gcc -c main.c -o main.o -I../../lexical_analyzer
 
 echo [5/5] 链接生成可执行文件...
-gcc scanner.o parser.o main.o -o recursive_parser.exe
+gcc scanner.o scan_simd.o token_stream.o token_cache.o token_pipe.o intern.o literal.o unicode.o ast.o trace.o parser.o main.o -o recursive_parser.exe -lpthread
 
 if exist recursive_parser.exe (
     echo 编译成功！运行语法分析器...
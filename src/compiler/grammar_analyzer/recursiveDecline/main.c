@@ -1,42 +1,117 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "parser.h"
 
-// 声明外部变量
-extern Token current_token;
-extern ASTNode* ast_root;
+// 输出收集到的语法错误，返回错误数
+static uint32_t report_syntax_errors() {
+    uint32_t count;
+    const SyntaxDiagnostic* errors = get_syntax_diagnostics(&count);
+    if (count == 0) {
+        printf("\n✅ 语法分析完成！\n");
+        return 0;
+    }
+    
+    printf("\n❌ 语法分析完成，发现 %u 个语法错误:\n", count);
+    for (uint32_t i = 0; i < count; i++) {
+        printf("   第%d行, 第%d列: %s（当前token: %s）\n",
+               errors[i].line, errors[i].column, errors[i].message, errors[i].text);
+    }
+    return count;
+}
 
-int main() {
+// 流水线模式：词法分析线程和语法分析同时运行，只能统计总耗时
+static int run_pipelined(const char* input_file, const char* output_file) {
+    clock_t start = clock();
+    TokenPipe* pipe = token_pipe_open(input_file);
+    if (!pipe) {
+        printf("错误：无法打开输入文件 %s\n", input_file);
+        return 1;
+    }
+    
+    printf("输入文件: %s\n", input_file);
+    printf("输出文件: %s\n\n", output_file);
+    
+    printf("开始语法分析（流水线模式）...\n");
+    printf("────────────────────────────────────────\n\n");
+    
+    init_parser_pipe(pipe);
+    parse_program();
+    double total_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    uint32_t error_count = report_syntax_errors();
+    printf("   Token数: %u\n", token_pipe_count(pipe));
+    printf("   语法树: %u 个节点, %zu 字节\n", ast_node_count(ast), ast_memory(ast));
+    printf("   词法+语法分析耗时: %.3f 秒\n\n", total_time);
+    
+    display_parse_process();
+    save_result(output_file);
+    
+    // 清理资源
+    free_ast();
+    token_pipe_close(pipe);
+    
+    printf("\n========================================\n");
+    
+    return error_count ? 1 : 0;
+}
+
+// 用法: recursive_parser [-p] [--trace=off|summary|full]
+//   -p  流水线模式：词法分析在单独的线程中进行，边分析边把Token交给语法分析
+//   --trace  分析过程的记录方式：不记录、只统计各产生式的次数、记录每一步（默认）
+int main(int argc, char* argv[]) {
     printf("========================================\n");
     printf("  实验二：递归下降语法分析器\n");
     printf("========================================\n\n");
     
     const char* input_file = "input.txt";
     const char* output_file = "analysis_result.txt";
+    int pipelined = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--pipeline") == 0) {
+            pipelined = 1;
+        } else if (strncmp(argv[i], "--trace=", 8) == 0 && trace_level_from_name(argv[i] + 8) >= 0) {
+            set_trace_level((TraceLevel)trace_level_from_name(argv[i] + 8));
+        } else {
+            printf("未知参数: %s\n", argv[i]);
+            printf("用法: %s [-p] [--trace=off|summary|full]\n", argv[0]);
+            return 1;
+        }
+    }
     
-    // 打开输入文件
-    FILE* input = fopen(input_file, "r");
-    if (!input) {
+    if (pipelined) {
+        return run_pipelined(input_file, output_file);
+    }
+    
+    // 一次性完成整个文件的词法分析（大文件自动分块并行）；源文件没有变化时直接加载上次写出的Token缓存
+    clock_t lex_start = clock();
+    int cache_hit;
+    TokenStream* tokens = tokenize_file_cached(input_file, 0, &cache_hit);
+    if (!tokens) {
         printf("错误：无法打开输入文件 %s\n", input_file);
         return 1;
     }
+    double lex_time = (double)(clock() - lex_start) / CLOCKS_PER_SEC;
     
     printf("输入文件: %s\n", input_file);
     printf("输出文件: %s\n\n", output_file);
     
-    // 初始化词法分析器
-    init_scanner(input);
-    
-    // 获取第一个token
-    current_token = get_next_token();
-    
     printf("开始语法分析...\n");
     printf("────────────────────────────────────────\n\n");
     
     // 执行语法分析
+    clock_t parse_start = clock();
+    init_parser(tokens);
     parse_program();
+    double parse_time = (double)(clock() - parse_start) / CLOCKS_PER_SEC;
     
-    printf("\n✅ 语法分析完成！\n\n");
+    uint32_t error_count = report_syntax_errors();
+    printf("   Token数: %u\n", tokens->count);
+    printf("   语法树: %u 个节点, %zu 字节\n", ast_node_count(ast), ast_memory(ast));
+    printf("   词法分析耗时: %.3f 秒%s\n", lex_time, cache_hit ? "（使用Token缓存 " TOKEN_CACHE_SUFFIX "）" : "");
+    printf("   语法分析耗时: %.3f 秒\n\n", parse_time);
     
     // 显示分析过程
     display_parse_process();
@@ -45,11 +120,10 @@ int main() {
     save_result(output_file);
     
     // 清理资源
-    free_ast(ast_root);
-    close_scanner();
-    fclose(input);
+    free_ast();
+    token_stream_destroy(tokens);
     
     printf("\n========================================\n");
     
-    return 0;
+    return error_count ? 1 : 0;
 }
\ No newline at end of file
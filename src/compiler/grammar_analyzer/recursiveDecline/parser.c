@@ -3,562 +3,688 @@
 #include <string.h>
 #include "parser.h"
 
-// 全局变量定义
-Token current_token;
-ParseStep steps[MAX_STEPS];
-int step_count = 0;
-int parse_depth = 0;
-ASTNode* ast_root = NULL;
+// 记录分析事件（编译时PARSE_TRACE_MAX为TRACE_OFF则整条语句被去掉）
+#define TRACE(kind, production) \
+    do { \
+        if (PARSE_TRACE_MAX > TRACE_OFF && p->trace.level != TRACE_OFF && \
+            !trace_record(&p->trace, kind, production, p->depth, p->token_index)) \
+            trace_out_of_memory(p); \
+    } while (0)
 
 // ==================== 工具函数 ====================
 
-// 创建AST节点
-ASTNode* create_node(NodeType type, const char* value, int line, int col) {
-    ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
-    node->type = type;
-    if (value) {
-        strncpy(node->value, value, 99);
-        node->value[99] = '\0';
-    } else {
-        node->value[0] = '\0';
+// 完整跟踪的缓冲区分配失败，已经降为只统计（分析照常进行）
+static void trace_out_of_memory(const Parser* p) {
+    printf("\n❌ 内存不足，不再记录分析过程，只统计（跟踪级别: %s）\n", trace_level_name(p->trace.level));
+}
+
+// 创建语法分析器（语法树在第一次分析时创建，之后的分析重用）
+Parser* parser_create() {
+    Parser* p = (Parser*)calloc(1, sizeof(Parser));
+    if (!p) return NULL;
+    p->trace_level = PARSE_TRACE_MAX;
+    return p;
+}
+
+// 释放语法树、分析过程记录和语法错误（Parser本身可以继续使用）
+static void parser_release(Parser* p) {
+    free(p->operands);
+    free(p->operators);
+    p->operands = NULL;
+    p->operators = NULL;
+    p->operand_count = p->operand_capacity = 0;
+    p->operator_count = p->operator_capacity = 0;
+    ast_destroy(p->ast);
+    p->ast = NULL;
+    p->root = AST_NONE;
+    trace_free(&p->trace);
+    free(p->diagnostics);
+    p->diagnostics = NULL;
+    p->diagnostic_count = 0;
+    p->diagnostic_capacity = 0;
+}
+
+void parser_destroy(Parser* p) {
+    if (!p) return;
+    parser_release(p);
+    free(p);
+}
+
+// 创建AST节点（值为0，由调用者按节点类型填写）
+AstId parser_create_node(Parser* p, NodeType type, int line, int col) {
+    AstId node = ast_add(p->ast, type, line, col);
+    if (node == AST_NONE) {
+        printf("\n❌ 内存不足\n");
+        exit(1);
     }
-    node->line = line;
-    node->column = col;
-    node->left = NULL;
-    node->right = NULL;
-    node->next = NULL;
     return node;
 }
 
-// 记录分析步骤
-void add_step(const char* stack, const char* input, const char* action) {
-    if (step_count >= MAX_STEPS) return;
-    
-    ParseStep* step = &steps[step_count];
-    step->step = step_count + 1;
-    step->depth = parse_depth;
-    
-    strncpy(step->stack, stack, 199);
-    step->stack[199] = '\0';
-    
-    strncpy(step->input, input, 199);
-    step->input[199] = '\0';
-    
-    strncpy(step->action, action, 99);
-    step->action[99] = '\0';
-    
-    step_count++;
+// 设置跟踪级别（从下一次parser_init开始生效），超过编译时允许的级别时取允许的最高级别
+void parser_set_trace_level(Parser* p, TraceLevel level) {
+    p->trace_level = level > PARSE_TRACE_MAX ? PARSE_TRACE_MAX : level;
+}
+
+// 设置要分析的Token序列
+void parser_init(Parser* p, TokenStream* tokens) {
+    p->tokens = tokens;
+    p->pipe = NULL;
+    p->token_index = 0;
+    p->current_token = token_stream_get(tokens, 0);
+    p->diagnostic_count = 0;
+    p->panic_mode = 0;
+    trace_start(&p->trace, p->trace_level, 0);
+}
+
+// 流水线模式：从词法分析线程取Token
+void parser_init_pipe(Parser* p, TokenPipe* pipe) {
+    p->tokens = NULL;
+    p->pipe = pipe;
+    p->token_index = 0;
+    p->current_token = token_pipe_next(pipe);
+    p->diagnostic_count = 0;
+    p->panic_mode = 0;
+    trace_start(&p->trace, p->trace_level, 1);
+    if (p->trace.level < p->trace_level || !trace_token(&p->trace, p->token_index, p->current_token)) {
+        trace_out_of_memory(p);
+    }
 }
 
 // 获取下一个token
-static void next_token() {
-    current_token = get_next_token();
+static void next_token(Parser* p) {
+    p->token_index++;
+    if (p->pipe) {
+        p->current_token = token_pipe_next(p->pipe);
+        if (!trace_token(&p->trace, p->token_index, p->current_token)) trace_out_of_memory(p);
+    } else {
+        p->current_token = token_stream_get(p->tokens, p->token_index);
+    }
+}
+
+// 当前token的文本（按需从源缓冲区取出）
+static const char* current_lexeme(Parser* p) {
+    if (p->pipe) return scanner_token_text(token_pipe_scanner(p->pipe), p->current_token, p->lexeme, sizeof(p->lexeme));
+    return token_stream_text(p->tokens, p->token_index, p->lexeme, sizeof(p->lexeme));
+}
+
+// 当前token的行号列号
+static void current_position(Parser* p, int* line, int* column) {
+    if (p->pipe) scanner_token_position(token_pipe_scanner(p->pipe), p->current_token, line, column);
+    else token_stream_position(p->tokens, p->token_index, line, column);
+}
+
+// 当前token的行号
+static int current_line(Parser* p) {
+    int line, column;
+    current_position(p, &line, &column);
+    return line;
+}
+
+// 当前token的列号
+static int current_column(Parser* p) {
+    int line, column;
+    current_position(p, &line, &column);
+    return column;
 }
 
 // 匹配token
-void match(TokenType expected) {
-    char action[100];
-    snprintf(action, sizeof(action), "匹配 %s", token_type_to_string(expected));
-    
-    char stack[100];
-    snprintf(stack, sizeof(stack), "期望: %s", token_type_to_string(expected));
-    
-    char input[100];
-    snprintf(input, sizeof(input), "当前: %s", current_token.lexeme);
-    
-    add_step(stack, input, action);
+void parser_match(Parser* p, TokenType expected) {
+    TRACE(EVENT_MATCH, expected);
     
-    if (current_token.type == expected) {
-        next_token();
-    } else {
+    if (p->current_token.type == expected) {
+        next_token(p);
+        p->panic_mode = 0;     // 又能正常匹配了，之后的错误照常记录
+    } else if (!p->panic_mode) {
         char error[200];
         snprintf(error, sizeof(error), "期望 %s, 但得到 %s", 
                 token_type_to_string(expected), 
-                token_type_to_string(current_token.type));
-        syntax_error(error);
+                token_type_to_string(p->current_token.type));
+        parser_syntax_error(p, error);
     }
 }
 
-// 语法错误
-void syntax_error(const char* message) {
-    printf("\n❌ 语法错误: %s\n", message);
-    printf("   位置: 第%d行, 第%d列\n", current_token.line, current_token.column);
-    printf("   当前token: %s\n", current_token.lexeme);
-    exit(1);
+// 语法错误：记录下来并进入恐慌模式，由parse_statement跳到语句边界后恢复
+void parser_syntax_error(Parser* p, const char* message) {
+    if (p->panic_mode) return;
+    p->panic_mode = 1;
+    
+    if (p->diagnostic_count == p->diagnostic_capacity) {
+        uint32_t capacity = p->diagnostic_capacity ? p->diagnostic_capacity * 2 : 16;
+        SyntaxDiagnostic* grown = (SyntaxDiagnostic*)realloc(p->diagnostics, capacity * sizeof(SyntaxDiagnostic));
+        if (!grown) return;
+        p->diagnostics = grown;
+        p->diagnostic_capacity = capacity;
+    }
+    
+    SyntaxDiagnostic* d = &p->diagnostics[p->diagnostic_count++];
+    current_position(p, &d->line, &d->column);
+    snprintf(d->message, sizeof(d->message), "%s", message);
+    snprintf(d->text, sizeof(d->text), "%s", current_lexeme(p));
+}
+
+// 错误恢复中丢弃当前Token（和匹配一样记录一个事件，见trace_token）
+static void skip_token(Parser* p) {
+    TRACE(EVENT_SKIP, p->current_token.type);
+    next_token(p);
+}
+
+// 同步：跳过Token直到语句边界。分号属于出错的语句，一并跳过；
+// end、else、EOF（statement的FOLLOW集）和if、while、begin（下一条语句的开始）留给调用者。
+// 标识符也可以开始语句，但它更可能是表达式的一部分，所以不在这里停下
+static void synchronize(Parser* p) {
+    while (p->current_token.type != TK_SEMICOLON && p->current_token.type != TK_END &&
+           p->current_token.type != TK_ELSE && p->current_token.type != TK_EOF &&
+           p->current_token.type != TK_IF && p->current_token.type != TK_WHILE &&
+           p->current_token.type != TK_BEGIN) {
+        skip_token(p);
+    }
+    if (p->current_token.type == TK_SEMICOLON) skip_token(p);
+    p->panic_mode = 0;
+}
+
+// 收集到的语法错误
+const SyntaxDiagnostic* parser_diagnostics(const Parser* p, uint32_t* count) {
+    *count = p->diagnostic_count;
+    return p->diagnostics;
 }
 
 // ==================== 递归下降分析函数 ====================
 
-// factor → ID | NUM | STR | ( expression )
-ASTNode* parse_factor() {
-    parse_depth++;
-    add_step("parse_factor", current_token.lexeme, "进入factor分析");
-    
-    ASTNode* node = NULL;
-    
-    if (current_token.type == TK_ID) {
-        add_step("factor → ID", current_token.lexeme, "识别标识符");
-        node = create_node(NODE_ID, current_token.lexeme, 
-                          current_token.line, current_token.column);
-        match(TK_ID);
-    }
-    else if (current_token.type == TK_NUM) {
-        add_step("factor → NUM", current_token.lexeme, "识别数字");
-        node = create_node(NODE_NUM, current_token.lexeme,
-                          current_token.line, current_token.column);
-        match(TK_NUM);
-    }
-    else if (current_token.type == TK_STR) {
-        add_step("factor → STRING", current_token.lexeme, "识别字符串");
-        node = create_node(NODE_STR, current_token.lexeme,
-                          current_token.line, current_token.column);
-        match(TK_STR);
-    }
-    else if (current_token.type == TK_LPAREN) {
-        add_step("factor → ( expression )", "(", "识别括号表达式");
-        match(TK_LPAREN);
-        node = parse_expression();
-        match(TK_RPAREN);
+// 表达式用算符优先分析，操作数和运算符放在Parser的两个显式栈中，括号不增加函数调用，
+// 嵌套多深都不会耗尽调用栈。优先级从低到高：关系运算符、+ -、* /，同级左结合。
+//   expression → term { (+ | -) term }
+//   term       → factor { (* | /) factor }
+//   factor     → ID | NUM | STR | ( expression )
+//   condition  → expression relop expression | expression
+// 生成的语法树与按上面的文法递归下降分析相同。
+
+// Token对应的二元运算符，不是二元运算符时为OP_NONE
+static AstOp binary_operator(TokenType type) {
+    switch (type) {
+        case TK_PLUS: return OP_ADD;
+        case TK_MINUS: return OP_SUB;
+        case TK_MUL: return OP_MUL;
+        case TK_DIV: return OP_DIV;
+        case TK_GT: return OP_GT;
+        case TK_LT: return OP_LT;
+        case TK_GE: return OP_GE;
+        case TK_LE: return OP_LE;
+        case TK_EQ: return OP_EQ;
+        case TK_NE: return OP_NE;
+        default: return OP_NONE;
+    }
+}
+
+// 运算符优先级（OP_NONE是栈中的左括号，优先级最低，归约到它为止）
+static int precedence(AstOp op) {
+    switch (op) {
+        case OP_MUL: case OP_DIV: return 3;
+        case OP_ADD: case OP_SUB: return 2;
+        case OP_NONE: return 0;
+        default: return 1;
+    }
+}
+
+// 运算符对应的产生式（分析过程中记录）
+static TraceRule operator_rule(AstOp op) {
+    switch (op) {
+        case OP_MUL: return RULE_TERM_MUL;
+        case OP_DIV: return RULE_TERM_DIV;
+        case OP_ADD: return RULE_EXPRESSION_ADD;
+        case OP_SUB: return RULE_EXPRESSION_SUB;
+        default: return RULE_CONDITION_RELOP;
+    }
+}
+
+// 扩大一个栈（失败时原数组保持不变）
+static void grow_stack(void** array, uint32_t* capacity, size_t element_size) {
+    uint32_t grown_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(*array, (size_t)grown_capacity * element_size);
+    if (!grown) {
+        printf("\n❌ 内存不足\n");
+        exit(1);
+    }
+    *array = grown;
+    *capacity = grown_capacity;
+}
+
+static void push_operand(Parser* p, AstId node) {
+    if (p->operand_count == p->operand_capacity) {
+        grow_stack((void**)&p->operands, &p->operand_capacity, sizeof(AstId));
+    }
+    p->operands[p->operand_count++] = node;
+}
+
+static void push_operator(Parser* p, AstOp op, int line, int column) {
+    if (p->operator_count == p->operator_capacity) {
+        grow_stack((void**)&p->operators, &p->operator_capacity, sizeof(PendingOperator));
+    }
+    PendingOperator* pending = &p->operators[p->operator_count++];
+    pending->op = op;
+    pending->line = line;
+    pending->column = column;
+}
+
+// 归约栈顶的运算符：弹出两个操作数，压入运算符节点
+// 关系运算符生成条件节点：两个孩子是左右表达式，运算符节点作为左表达式的兄弟
+static void reduce(Parser* p) {
+    PendingOperator pending = p->operators[--p->operator_count];
+    AstId right = p->operands[--p->operand_count];
+    AstId left = p->operands[--p->operand_count];
+    
+    AstId node;
+    if (ast_op_is_relational(pending.op)) {
+        node = parser_create_node(p, NODE_CONDITION, pending.line, pending.column);
+        AstId relop_node = parser_create_node(p, NODE_RELOP, pending.line, pending.column);
+        p->ast->payloads[relop_node].op = pending.op;
+        p->ast->nexts[left] = relop_node;
+    } else {
+        node = parser_create_node(p, NODE_BINARY_OP, pending.line, pending.column);
+        p->ast->payloads[node].op = pending.op;
+    }
+    p->ast->lefts[node] = left;
+    p->ast->rights[node] = right;
+    p->operands[p->operand_count++] = node;
+}
+
+// 操作数：ID | NUM | STR（括号由parse_operators处理）
+static AstId parse_operand(Parser* p) {
+    AstId node;
+    
+    if (p->current_token.type == TK_ID) {
+        TRACE(EVENT_RULE, RULE_FACTOR_ID);
+        node = parser_create_node(p, NODE_ID, current_line(p), current_column(p));
+        p->ast->payloads[node].name = p->current_token.value;
+        parser_match(p, TK_ID);
+    }
+    else if (p->current_token.type == TK_NUM) {
+        TRACE(EVENT_RULE, RULE_FACTOR_NUM);
+        node = parser_create_node(p, NODE_NUM, current_line(p), current_column(p));
+        p->ast->payloads[node].literal = p->current_token.value;
+        parser_match(p, TK_NUM);
+    }
+    else if (p->current_token.type == TK_STR) {
+        TRACE(EVENT_RULE, RULE_FACTOR_STR);
+        node = parser_create_node(p, NODE_STR, current_line(p), current_column(p));
+        p->ast->payloads[node].name = p->current_token.value;
+        parser_match(p, TK_STR);
     }
     else {
-        syntax_error("期望因子: ID, NUM, STRING 或 (expression)");
+        // 缺少因子：用错误节点代替，不跳过Token（通常是运算符或语句结束符，后面还用得上）
+        node = parser_create_node(p, NODE_ERROR, current_line(p), current_column(p));
+        parser_syntax_error(p, "期望因子: ID, NUM, STRING 或 (expression)");
     }
     
-    add_step("parse_factor", "完成", "退出factor分析");
-    parse_depth--;
     return node;
 }
 
-// term → factor { (* | /) factor }
-ASTNode* parse_term() {
-    parse_depth++;
-    add_step("parse_term", current_token.lexeme, "进入term分析");
+// 算符优先分析：交替读入操作数和运算符，遇到不比栈顶高的运算符时先归约栈顶。
+// allow_relop为真时（条件中）括号外可以出现一个关系运算符
+static AstId parse_operators(Parser* p, int allow_relop) {
+    uint32_t operator_base = p->operator_count;
+    int parens = 0;
+    
+    for (;;) {
+        // 操作数前可以有任意多个左括号
+        while (p->current_token.type == TK_LPAREN) {
+            TRACE(EVENT_RULE, RULE_FACTOR_PAREN);
+            push_operator(p, OP_NONE, 0, 0);
+            parser_match(p, TK_LPAREN);
+            parens++;
+            p->depth++;
+        }
+        push_operand(p, parse_operand(p));
+    
+        // 操作数后可以有任意多个右括号；括号未闭合时遇到其他Token，按缺少右括号处理
+        AstOp op;
+        for (;;) {
+            op = binary_operator(p->current_token.type);
+            if (ast_op_is_relational(op) && (!allow_relop || parens > 0)) op = OP_NONE;
+            if (op != OP_NONE || parens == 0) break;
+    
+            while (p->operators[p->operator_count - 1].op != OP_NONE) reduce(p);
+            p->operator_count--;
+            parser_match(p, TK_RPAREN);
+            parens--;
+            p->depth--;
+        }
+        if (op == OP_NONE) break;
     
-    ASTNode* node = parse_factor();
+        TRACE(EVENT_RULE, operator_rule(op));
+        int op_line = current_line(p);
+        int op_col = current_column(p);
+        parser_match(p, p->current_token.type);
     
-    while (current_token.type == TK_MUL || current_token.type == TK_DIV) {
-        char op[10];
-        if (current_token.type == TK_MUL) {
-            strcpy(op, "*");
-            add_step("term → term * factor", "*", "识别乘法");
-        } else {
-            strcpy(op, "/");
-            add_step("term → term / factor", "/", "识别除法");
+        while (p->operator_count > operator_base &&
+               precedence(p->operators[p->operator_count - 1].op) >= precedence(op)) {
+            reduce(p);
         }
-        
-        int op_line = current_token.line;
-        int op_col = current_token.column;
-        match(current_token.type);
-        
-        ASTNode* right = parse_factor();
-        ASTNode* op_node = create_node(NODE_BINARY_OP, op, op_line, op_col);
-        op_node->left = node;
-        op_node->right = right;
-        node = op_node;
-    }
-    
-    add_step("parse_term", "完成", "退出term分析");
-    parse_depth--;
-    return node;
+        push_operator(p, op, op_line, op_col);
+        if (ast_op_is_relational(op)) allow_relop = 0;     // 只允许一个关系运算符
+    }
+    
+    while (p->operator_count > operator_base) reduce(p);
+    return p->operands[--p->operand_count];
 }
 
 // expression → term { (+ | -) term }
-ASTNode* parse_expression() {
-    parse_depth++;
-    add_step("parse_expression", current_token.lexeme, "进入expression分析");
+AstId parser_parse_expression(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_EXPRESSION);
     
-    ASTNode* node = parse_term();
+    AstId node = parse_operators(p, 0);
     
-    while (current_token.type == TK_PLUS || current_token.type == TK_MINUS) {
-        char op[10];
-        if (current_token.type == TK_PLUS) {
-            strcpy(op, "+");
-            add_step("expression → expression + term", "+", "识别加法");
-        } else {
-            strcpy(op, "-");
-            add_step("expression → expression - term", "-", "识别减法");
-        }
-        
-        int op_line = current_token.line;
-        int op_col = current_token.column;
-        match(current_token.type);
-        
-        ASTNode* right = parse_term();
-        ASTNode* op_node = create_node(NODE_BINARY_OP, op, op_line, op_col);
-        op_node->left = node;
-        op_node->right = right;
-        node = op_node;
-    }
-    
-    add_step("parse_expression", "完成", "退出expression分析");
-    parse_depth--;
+    TRACE(EVENT_EXIT, SYM_EXPRESSION);
+    p->depth--;
     return node;
 }
 
 // condition → expression relop expression | expression
-ASTNode* parse_condition() {
-    parse_depth++;
-    add_step("parse_condition", current_token.lexeme, "进入condition分析");
-    
-    // 解析左侧表达式
-    ASTNode* left_expr = parse_expression();
-    
-    // 检查是否是关系运算符
-    if (current_token.type == TK_GT || current_token.type == TK_LT ||
-        current_token.type == TK_GE || current_token.type == TK_LE ||
-        current_token.type == TK_EQ || current_token.type == TK_NE) {
-        
-        // 是关系表达式
-        char relop[10];
-        switch (current_token.type) {
-            case TK_GT: strcpy(relop, ">"); break;
-            case TK_LT: strcpy(relop, "<"); break;
-            case TK_GE: strcpy(relop, ">="); break;
-            case TK_LE: strcpy(relop, "<="); break;
-            case TK_EQ: strcpy(relop, "=="); break;
-            case TK_NE: strcpy(relop, "!="); break;
-            default: strcpy(relop, "??"); break;
-        }
-        
-        add_step("condition → expression relop expression", relop, "识别关系表达式");
-        
-        int relop_line = current_token.line;
-        int relop_col = current_token.column;
-        match(current_token.type);
-        
-        // 解析右侧表达式
-        ASTNode* right_expr = parse_expression();
-        
-        // 创建条件节点
-        ASTNode* cond_node = create_node(NODE_CONDITION, "condition", relop_line, relop_col);
-        ASTNode* relop_node = create_node(NODE_RELOP, relop, relop_line, relop_col);
-        
-        // 构建条件树：cond_node作为根，左子节点是左表达式，右子节点是右表达式
-        // 关系运算符附加到左表达式上
-        cond_node->left = left_expr;
-        cond_node->right = right_expr;
-        left_expr->next = relop_node;  // 关系运算符作为左表达式的兄弟
-        
-        add_step("parse_condition", "完成", "退出condition分析");
-        parse_depth--;
-        return cond_node;
-    } else {
+AstId parser_parse_condition(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_CONDITION);
+    
+    AstId node = parse_operators(p, 1);
+    if (p->ast->kinds[node] != NODE_CONDITION) {
         // 只是简单表达式作为条件
-        add_step("condition → expression", "简单条件", "无关系运算符");
-        add_step("parse_condition", "完成", "退出condition分析");
-        parse_depth--;
-        return left_expr;
+        TRACE(EVENT_RULE, RULE_CONDITION_SIMPLE);
     }
+    
+    TRACE(EVENT_EXIT, SYM_CONDITION);
+    p->depth--;
+    return node;
 }
 
 // assignment → ID = expression ;
-ASTNode* parse_assignment() {
-    parse_depth++;
-    add_step("parse_assignment", current_token.lexeme, "进入assignment分析");
+AstId parser_parse_assignment(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_ASSIGNMENT);
     
-    // 保存变量名
-    char var_name[100];
-    strcpy(var_name, current_token.lexeme);
-    int var_line = current_token.line;
-    int var_col = current_token.column;
+    // 保存变量名（调用前已确认是ID）
+    uint32_t var_name = p->current_token.value;
+    int var_line = current_line(p);
+    int var_col = current_column(p);
     
-    add_step("assignment → ID = expression ;", var_name, "识别赋值语句");
+    TRACE(EVENT_RULE, RULE_ASSIGNMENT);
     
-    match(TK_ID);
-    match(TK_ASSIGN);
+    parser_match(p, TK_ID);
+    parser_match(p, TK_ASSIGN);
     
-    ASTNode* expr_node = parse_expression();
-    match(TK_SEMICOLON);
+    AstId expr_node = parser_parse_expression(p);
+    parser_match(p, TK_SEMICOLON);
     
-    ASTNode* assign_node = create_node(NODE_ASSIGNMENT, var_name, var_line, var_col);
-    assign_node->left = expr_node;
+    AstId assign_node = parser_create_node(p, NODE_ASSIGNMENT, var_line, var_col);
+    p->ast->payloads[assign_node].name = var_name;
+    p->ast->lefts[assign_node] = expr_node;
     
-    add_step("parse_assignment", "完成", "退出assignment分析");
-    parse_depth--;
+    TRACE(EVENT_EXIT, SYM_ASSIGNMENT);
+    p->depth--;
     return assign_node;
 }
 
 // if_statement → if condition then statement [else statement]
-ASTNode* parse_if() {
-    parse_depth++;
-    add_step("parse_if", current_token.lexeme, "进入if分析");
+AstId parser_parse_if(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_IF);
     
-    int if_line = current_token.line;
-    int if_col = current_token.column;
-    match(TK_IF);
+    int if_line = current_line(p);
+    int if_col = current_column(p);
+    parser_match(p, TK_IF);
     
     // 解析条件表达式
-    ASTNode* cond_node = parse_condition();
-    match(TK_THEN);
+    AstId cond_node = parser_parse_condition(p);
+    parser_match(p, TK_THEN);
     
     // 解析then语句
-    ASTNode* then_node = parse_statement();
+    AstId then_node = parser_parse_statement(p);
     
-    ASTNode* if_node = create_node(NODE_IF, "if", if_line, if_col);
-    if_node->left = cond_node;
-    if_node->right = then_node;
+    AstId if_node = parser_create_node(p, NODE_IF, if_line, if_col);
+    p->ast->lefts[if_node] = cond_node;
+    p->ast->rights[if_node] = then_node;
     
     // 可选的else部分
-    if (current_token.type == TK_ELSE) {
-        add_step("if → if ... else statement", "else", "识别else分支");
-        match(TK_ELSE);
-        ASTNode* else_node = parse_statement();
-        
+    if (p->current_token.type == TK_ELSE) {
+        TRACE(EVENT_RULE, RULE_IF_ELSE);
+        parser_match(p, TK_ELSE);
+        AstId else_node = parser_parse_statement(p);
+    
         // 创建新节点存储else
-        ASTNode* if_else_node = create_node(NODE_IF, "if-else", if_line, if_col);
-        if_else_node->left = if_node;
-        if_else_node->right = else_node;
+        AstId if_else_node = parser_create_node(p, NODE_IF, if_line, if_col);
+        p->ast->payloads[if_else_node].has_else = 1;
+        p->ast->lefts[if_else_node] = if_node;
+        p->ast->rights[if_else_node] = else_node;
         if_node = if_else_node;
     }
     
-    add_step("parse_if", "完成", "退出if分析");
-    parse_depth--;
+    TRACE(EVENT_EXIT, SYM_IF);
+    p->depth--;
     return if_node;
 }
 
 // while_statement → while condition do statement
-ASTNode* parse_while() {
-    parse_depth++;
-    add_step("parse_while", current_token.lexeme, "进入while分析");
+AstId parser_parse_while(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_WHILE);
     
-    int while_line = current_token.line;
-    int while_col = current_token.column;
-    match(TK_WHILE);
+    int while_line = current_line(p);
+    int while_col = current_column(p);
+    parser_match(p, TK_WHILE);
     
     // 解析条件
-    ASTNode* cond_node = parse_condition();
-    match(TK_DO);
+    AstId cond_node = parser_parse_condition(p);
+    parser_match(p, TK_DO);
     
     // 解析循环体
-    ASTNode* body_node = parse_statement();
+    AstId body_node = parser_parse_statement(p);
     
-    ASTNode* while_node = create_node(NODE_WHILE, "while", while_line, while_col);
-    while_node->left = cond_node;
-    while_node->right = body_node;
+    AstId while_node = parser_create_node(p, NODE_WHILE, while_line, while_col);
+    p->ast->lefts[while_node] = cond_node;
+    p->ast->rights[while_node] = body_node;
     
-    add_step("parse_while", "完成", "退出while分析");
-    parse_depth--;
+    TRACE(EVENT_EXIT, SYM_WHILE);
+    p->depth--;
     return while_node;
 }
 
 // block → begin { statement } end
-ASTNode* parse_block() {
-    parse_depth++;
-    add_step("parse_block", current_token.lexeme, "进入block分析");
+AstId parser_parse_block(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_BLOCK);
     
-    int block_line = current_token.line;
-    int block_col = current_token.column;
-    match(TK_BEGIN);
+    int block_line = current_line(p);
+    int block_col = current_column(p);
+    parser_match(p, TK_BEGIN);
     
-    ASTNode* block_node = create_node(NODE_BLOCK, "block", block_line, block_col);
-    ASTNode* last_stmt = NULL;
+    AstId block_node = parser_create_node(p, NODE_BLOCK, block_line, block_col);
+    AstId last_stmt = AST_NONE;
     
     // 解析语句列表直到遇到end
-    while (current_token.type != TK_END && current_token.type != TK_EOF) {
-        ASTNode* stmt = parse_statement();
-        
+    while (p->current_token.type != TK_END && p->current_token.type != TK_EOF) {
+        AstId stmt = parser_parse_statement(p);
+    
         // 添加到语句链表
-        if (last_stmt == NULL) {
-            block_node->left = stmt;
+        if (last_stmt == AST_NONE) {
+            p->ast->lefts[block_node] = stmt;
         } else {
-            last_stmt->next = stmt;
+            p->ast->nexts[last_stmt] = stmt;
         }
         last_stmt = stmt;
+    
+        // 没有if与之对应的else：语句分析和同步都停在它前面，在这里跳过，保证循环能前进
+        if (p->current_token.type == TK_ELSE) skip_token(p);
     }
     
-    match(TK_END);
+    parser_match(p, TK_END);
     
-    add_step("parse_block", "完成", "退出block分析");
-    parse_depth--;
+    TRACE(EVENT_EXIT, SYM_BLOCK);
+    p->depth--;
     return block_node;
 }
 
 // statement → assignment | if | while | block
-ASTNode* parse_statement() {
-    parse_depth++;
-    add_step("parse_statement", current_token.lexeme, "进入statement分析");
+AstId parser_parse_statement(Parser* p) {
+    p->depth++;
+    TRACE(EVENT_ENTER, SYM_STATEMENT);
     
-    ASTNode* node = NULL;
+    AstId node = AST_NONE;
     
-    if (current_token.type == TK_ID) {
-        node = parse_assignment();
+    if (p->current_token.type == TK_ID) {
+        node = parser_parse_assignment(p);
     }
-    else if (current_token.type == TK_IF) {
-        node = parse_if();
+    else if (p->current_token.type == TK_IF) {
+        node = parser_parse_if(p);
     }
-    else if (current_token.type == TK_WHILE) {
-        node = parse_while();
+    else if (p->current_token.type == TK_WHILE) {
+        node = parser_parse_while(p);
     }
-    else if (current_token.type == TK_BEGIN) {
-        node = parse_block();
+    else if (p->current_token.type == TK_BEGIN) {
+        node = parser_parse_block(p);
     }
     else {
-        syntax_error("期望语句开始: ID, IF, WHILE 或 BEGIN");
+        // 无法开始语句：用错误节点代替。FOLLOW(statement)中的Token（end、else、;、EOF）
+        // 留给下面的同步和调用者处理（如while体为空时的end属于外层block），其他Token至少跳过一个
+        node = parser_create_node(p, NODE_ERROR, current_line(p), current_column(p));
+        parser_syntax_error(p, "期望语句开始: ID, IF, WHILE 或 BEGIN");
+        TokenType type = p->current_token.type;
+        if (type != TK_END && type != TK_ELSE && type != TK_SEMICOLON && type != TK_EOF) skip_token(p);
     }
     
-    add_step("parse_statement", "完成", "退出statement分析");
-    parse_depth--;
+    if (p->panic_mode) synchronize(p);
+    
+    TRACE(EVENT_EXIT, SYM_STATEMENT);
+    p->depth--;
     return node;
 }
 
 // program → block
-void parse_program() {
-    parse_depth = 0;
-    step_count = 0;
+void parser_parse_program(Parser* p) {
+    p->depth = 0;
     
-    add_step("parse_program", "开始", "程序分析开始");
+    TRACE(EVENT_ENTER, SYM_PROGRAM);
     
-    // 初始化根节点
-    ast_root = create_node(NODE_PROGRAM, "program", 1, 1);
+    // 初始化根节点（重用上一次分析的语法树数组，上一棵树随之作废）
+    if (p->ast) {
+        ast_reset(p->ast);
+    } else if (!(p->ast = ast_create())) {
+        printf("\n❌ 内存不足\n");
+        exit(1);
+    }
+    p->root = parser_create_node(p, NODE_PROGRAM, 1, 1);
     
     // 解析程序
-    ASTNode* program_block = parse_block();
-    ast_root->left = program_block;
+    AstId program_block = parser_parse_block(p);
+    p->ast->lefts[p->root] = program_block;
     
-    if (current_token.type != TK_EOF) {
-        syntax_error("期望文件结束");
+    if (p->current_token.type != TK_EOF) {
+        parser_syntax_error(p, "期望文件结束");
     }
     
-    add_step("parse_program", "完成", "程序分析完成");
+    TRACE(EVENT_EXIT, SYM_PROGRAM);
 }
 
-// ==================== 辅助函数 ====================
+// ==================== 输出函数 ====================
 
-// 递归写入AST到文件
-static void write_ast_to_file(FILE* file, ASTNode* node, int depth) {
-    if (!node) return;
-    
-    for (int i = 0; i < depth; i++) fprintf(file, "  ");
-    
-    const char* type_str;
-    switch (node->type) {
-        case NODE_PROGRAM: type_str = "Program"; break;
-        case NODE_BLOCK: type_str = "Block"; break;
-        case NODE_STATEMENT: type_str = "Statement"; break;
-        case NODE_ASSIGNMENT: type_str = "Assignment"; break;
-        case NODE_IF: type_str = "If"; break;
-        case NODE_WHILE: type_str = "While"; break;
-        case NODE_EXPRESSION: type_str = "Expression"; break;
-        case NODE_TERM: type_str = "Term"; break;
-        case NODE_FACTOR: type_str = "Factor"; break;
-        case NODE_ID: type_str = "ID"; break;
-        case NODE_NUM: type_str = "NUM"; break;
-        case NODE_STR: type_str = "STRING"; break;
-        case NODE_BINARY_OP: type_str = "BinaryOp"; break;
-        case NODE_CONDITION: type_str = "Condition"; break;
-        case NODE_RELOP: type_str = "RelOp"; break;
-        default: type_str = "Unknown"; break;
+// 事件所在Token的文本
+static const char* event_token_text(const Parser* p, const TraceEvent* event, char* buffer, size_t size) {
+    if (p->pipe) {
+        return scanner_token_text(token_pipe_scanner(p->pipe), trace_token_at(&p->trace, event->token), buffer, size);
+    }
+    return token_stream_text(p->tokens, event->token, buffer, size);
+}
+
+// 输出分析过程：完整跟踪时逐步格式化记录下来的事件，摘要跟踪时输出统计
+static void write_parse_process(const Parser* p, FILE* out) {
+    if (p->trace.level == TRACE_OFF) {
+        fprintf(out, "（未记录分析过程，跟踪级别: %s）\n", trace_level_name(TRACE_OFF));
+        return;
     }
     
-    if (node->value[0] != '\0') {
-        fprintf(file, "%s: %s", type_str, node->value);
-        if (node->line > 0) fprintf(file, " (行:%d)", node->line);
-        fprintf(file, "\n");
-    } else {
-        fprintf(file, "%s\n", type_str);
+    if (p->trace.level == TRACE_SUMMARY) {
+        if (p->trace_level == TRACE_FULL) {
+            fprintf(out, "（内存不足，未能记录完整的分析过程，以下只是统计）\n");
+        }
+        fprintf(out, "%-40s %s\n", "分析函数/产生式", "次数");
+        fprintf(out, "%-40s %s\n", "------------", "----");
+        for (int sym = 0; sym < SYM_COUNT; sym++) {
+            if (p->trace.symbol_counts[sym] == 0) continue;
+            TraceEvent event = { EVENT_ENTER, (uint8_t)sym, 0, 0 };
+            fprintf(out, "%-40s %llu\n", trace_text(&event).stack, (unsigned long long)p->trace.symbol_counts[sym]);
+        }
+        for (int rule = 0; rule < RULE_COUNT; rule++) {
+            if (p->trace.rule_counts[rule] == 0) continue;
+            TraceEvent event = { EVENT_RULE, (uint8_t)rule, 0, 0 };
+            fprintf(out, "%-40s %llu\n", trace_text(&event).stack, (unsigned long long)p->trace.rule_counts[rule]);
+        }
+        fprintf(out, "%-40s %llu\n", "匹配终结符", (unsigned long long)p->trace.match_count);
+        if (p->trace.skip_count > 0) {
+            fprintf(out, "%-40s %llu\n", "错误恢复跳过的终结符", (unsigned long long)p->trace.skip_count);
+        }
+        fprintf(out, "%-40s %d\n", "最大递归深度", p->trace.max_depth);
+        return;
     }
     
-    write_ast_to_file(file, node->left, depth + 1);
-    write_ast_to_file(file, node->right, depth + 1);
+    fprintf(out, "%-6s %-8s %-30s %-25s %s\n", 
+            "步骤", "深度", "分析栈/状态", "当前输入", "动作");
+    fprintf(out, "%-6s %-8s %-30s %-25s %s\n", 
+            "----", "----", "----------", "--------", "----");
     
-    if (node->next) {
-        write_ast_to_file(file, node->next, depth);
-    }
-}
-
-// ==================== 输出函数 ====================
-
-// 打印AST
-void print_ast(ASTNode* node, int depth) {
-    if (!node) return;
-    
-    for (int i = 0; i < depth; i++) printf("  ");
-    
-    const char* type_str;
-    switch (node->type) {
-        case NODE_PROGRAM: type_str = "Program"; break;
-        case NODE_BLOCK: type_str = "Block"; break;
-        case NODE_STATEMENT: type_str = "Statement"; break;
-        case NODE_ASSIGNMENT: type_str = "Assignment"; break;
-        case NODE_IF: type_str = "If"; break;
-        case NODE_WHILE: type_str = "While"; break;
-        case NODE_EXPRESSION: type_str = "Expression"; break;
-        case NODE_TERM: type_str = "Term"; break;
-        case NODE_FACTOR: type_str = "Factor"; break;
-        case NODE_ID: type_str = "ID"; break;
-        case NODE_NUM: type_str = "NUM"; break;
-        case NODE_STR: type_str = "STRING"; break;
-        case NODE_BINARY_OP: type_str = "BinaryOp"; break;
-        case NODE_CONDITION: type_str = "Condition"; break;
-        case NODE_RELOP: type_str = "RelOp"; break;
-        default: type_str = "Unknown"; break;
-    }
-    
-    if (node->value[0] != '\0') {
-        printf("%s: %s", type_str, node->value);
-        if (node->line > 0) printf(" (行:%d)", node->line);
-        printf("\n");
-    } else {
-        printf("%s\n", type_str);
+    uint64_t first = trace_first(&p->trace);
+    if (first > 0) {
+        fprintf(out, "（共%llu步，只保留了最后%llu步）\n",
+                (unsigned long long)p->trace.total, (unsigned long long)(p->trace.total - first));
     }
     
-    print_ast(node->left, depth + 1);
-    print_ast(node->right, depth + 1);
+    for (uint64_t i = first; i < p->trace.total; i++) {
+        const TraceEvent* event = trace_get(&p->trace, i);
+        char token_text[256];
+        char stack[150];
+        char input[200];
+        char action[100];
+    
+        if (event->kind == EVENT_MATCH) {
+            const char* expected = token_type_to_string((TokenType)event->production);
+            snprintf(stack, sizeof(stack), "%*s期望: %s", event->depth * 2, "", expected);
+            snprintf(input, sizeof(input), "当前: %s", event_token_text(p, event, token_text, sizeof(token_text)));
+            snprintf(action, sizeof(action), "匹配 %s", expected);
+        } else if (event->kind == EVENT_SKIP) {
+            snprintf(stack, sizeof(stack), "%*s跳过: %s", event->depth * 2, "", token_type_to_string((TokenType)event->production));
+            snprintf(input, sizeof(input), "当前: %s", event_token_text(p, event, token_text, sizeof(token_text)));
+            snprintf(action, sizeof(action), "错误恢复");
+        } else {
+            TraceText text = trace_text(event);
+            snprintf(stack, sizeof(stack), "%*s%s", event->depth * 2, "", text.stack);
+            snprintf(input, sizeof(input), "%s", text.input ? text.input : event_token_text(p, event, token_text, sizeof(token_text)));
+            snprintf(action, sizeof(action), "%s", text.action);
+        }
     
-    if (node->next) {
-        print_ast(node->next, depth);
+        fprintf(out, "%-6llu %-8d %-30s %-25s %s\n", 
+                (unsigned long long)(i + 1),
+                event->depth,
+                stack,
+                input,
+                action);
     }
 }
 
-// 释放AST内存
-void free_ast(ASTNode* node) {
-    if (!node) return;
-    free_ast(node->left);
-    free_ast(node->right);
-    free_ast(node->next);
-    free(node);
-}
-
 // 显示分析过程
-void display_parse_process() {
+void parser_display(const Parser* p) {
     printf("\n════════════════════════════════════════════════════════════\n");
     printf("                递归下降语法分析过程\n");
     printf("════════════════════════════════════════════════════════════\n\n");
     
-    printf("%-6s %-8s %-30s %-25s %s\n", 
-           "步骤", "深度", "分析栈/状态", "当前输入", "动作");
-    printf("%-6s %-8s %-30s %-25s %s\n", 
-           "----", "----", "----------", "--------", "----");
-    
-    for (int i = 0; i < step_count; i++) {
-        ParseStep* step = &steps[i];
-        
-        // 根据深度缩进
-        char indent[20] = "";
-        for (int j = 0; j < step->depth; j++) strcat(indent, "  ");
-        
-        char stack[150];
-        snprintf(stack, sizeof(stack), "%s%s", indent, step->stack);
-        
-        printf("%-6d %-8d %-30s %-25s %s\n", 
-               step->step,
-               step->depth,
-               stack,
-               step->input,
-               step->action);
-    }
+    write_parse_process(p, stdout);
     
     printf("\n════════════════════════════════════════════════════════════\n");
     printf("                    抽象语法树(AST)\n");
     printf("════════════════════════════════════════════════════════════\n\n");
     
-    if (ast_root) {
-        print_ast(ast_root, 0);
+    if (p->root != AST_NONE) {
+        ast_write(p->ast, p->root, 0, stdout);
     }
 }
 
 // 保存结果
-void save_result(const char* filename) {
+void parser_save_result(const Parser* p, const char* filename) {
     FILE* f = fopen(filename, "w");
     if (!f) {
         printf("无法打开文件: %s\n", filename);
@@ -569,32 +695,109 @@ void save_result(const char* filename) {
     fprintf(f, "════════════════════════════════════════════════════════════\n\n");
     
     fprintf(f, "分析过程:\n");
-    fprintf(f, "%-6s %-8s %-30s %-25s %s\n", 
-            "步骤", "深度", "分析栈/状态", "当前输入", "动作");
-    fprintf(f, "%-6s %-8s %-30s %-25s %s\n", 
-            "----", "----", "----------", "--------", "----");
+    write_parse_process(p, f);
     
-    for (int i = 0; i < step_count; i++) {
-        ParseStep* step = &steps[i];
-        
-        char indent[20] = "";
-        for (int j = 0; j < step->depth; j++) strcat(indent, "  ");
-        
-        char stack[150];
-        snprintf(stack, sizeof(stack), "%s%s", indent, step->stack);
-        
-        fprintf(f, "%-6d %-8d %-30s %-25s %s\n", 
-                step->step,
-                step->depth,
-                stack,
-                step->input,
-                step->action);
+    if (p->diagnostic_count > 0) {
+        fprintf(f, "\n语法错误（%u个）:\n", p->diagnostic_count);
+        for (uint32_t i = 0; i < p->diagnostic_count; i++) {
+            fprintf(f, "第%d行, 第%d列: %s（当前token: %s）\n",
+                    p->diagnostics[i].line, p->diagnostics[i].column, p->diagnostics[i].message, p->diagnostics[i].text);
+        }
     }
     
     fprintf(f, "\n抽象语法树(AST):\n");
     
-    write_ast_to_file(f, ast_root, 0);
+    if (p->root != AST_NONE) ast_write(p->ast, p->root, 0, f);
     fclose(f);
     
     printf("结果已保存到: %s\n", filename);
-}
\ No newline at end of file
+}
+
+// ==================== 兼容接口 ====================
+
+// 旧接口共用的默认分析器，ast和ast_root指向它的语法树
+static Parser global_parser = { .trace_level = PARSE_TRACE_MAX };
+Ast* ast = NULL;
+AstId ast_root = AST_NONE;
+
+void set_trace_level(TraceLevel level) {
+    parser_set_trace_level(&global_parser, level);
+}
+
+void init_parser(TokenStream* tokens) {
+    parser_init(&global_parser, tokens);
+}
+
+void init_parser_pipe(TokenPipe* pipe) {
+    parser_init_pipe(&global_parser, pipe);
+}
+
+void parse_program() {
+    parser_parse_program(&global_parser);
+    ast = global_parser.ast;
+    ast_root = global_parser.root;
+}
+
+AstId parse_block() {
+    return parser_parse_block(&global_parser);
+}
+
+AstId parse_statement() {
+    return parser_parse_statement(&global_parser);
+}
+
+AstId parse_assignment() {
+    return parser_parse_assignment(&global_parser);
+}
+
+AstId parse_if() {
+    return parser_parse_if(&global_parser);
+}
+
+AstId parse_while() {
+    return parser_parse_while(&global_parser);
+}
+
+AstId parse_expression() {
+    return parser_parse_expression(&global_parser);
+}
+
+AstId parse_condition() {
+    return parser_parse_condition(&global_parser);
+}
+
+AstId create_node(NodeType type, int line, int col) {
+    return parser_create_node(&global_parser, type, line, col);
+}
+
+void match(TokenType expected) {
+    parser_match(&global_parser, expected);
+}
+
+void syntax_error(const char* message) {
+    parser_syntax_error(&global_parser, message);
+}
+
+const SyntaxDiagnostic* get_syntax_diagnostics(uint32_t* count) {
+    return parser_diagnostics(&global_parser, count);
+}
+
+void display_parse_process() {
+    parser_display(&global_parser);
+}
+
+void save_result(const char* filename) {
+    parser_save_result(&global_parser, filename);
+}
+
+// 打印默认分析器语法树中的节点
+void print_ast(AstId node, int depth) {
+    ast_write(global_parser.ast, node, depth, stdout);
+}
+
+// 释放默认分析器的语法树、分析过程记录和语法错误
+void free_ast() {
+    parser_release(&global_parser);
+    ast = NULL;
+    ast_root = AST_NONE;
+}
@@ -2,76 +2,107 @@
 #define RECURSIVE_PARSER_H
 
 #include "../../lexical_analyzer/scanner.h"
+#include "../../lexical_analyzer/token_stream.h"
+#include "../../lexical_analyzer/token_cache.h"
+#include "../../lexical_analyzer/token_pipe.h"
+#include "../../lexical_analyzer/intern.h"
+#include "../../lexical_analyzer/literal.h"
+#include "ast.h"
+#include "trace.h"
 
-#define MAX_STEPS 1000
-
-// 语法树节点类型
-typedef enum {
-    NODE_PROGRAM,
-    NODE_BLOCK,
-    NODE_STATEMENT,
-    NODE_ASSIGNMENT,
-    NODE_IF,
-    NODE_WHILE,
-    NODE_EXPRESSION,
-    NODE_TERM,
-    NODE_FACTOR,
-    NODE_ID,
-    NODE_NUM,
-    NODE_STR,
-    NODE_BINARY_OP,
-    NODE_CONDITION,
-    NODE_RELOP
-} NodeType;
+// 语法错误（出错后跳到语句边界继续分析，一次分析收集所有错误）
+typedef struct {
+    int line;               // 行号
+    int column;             // 列号
+    char message[128];      // 错误信息
+    char text[32];          // 出错处的Token文本（截断，以'\0'结尾）
+} SyntaxDiagnostic;
 
-// 语法树节点
-typedef struct ASTNode {
-    NodeType type;
-    char value[100];
+// 表达式分析栈中尚未归约的运算符（左括号记为OP_NONE）
+typedef struct {
+    AstOp op;
     int line;
     int column;
-    struct ASTNode* left;
-    struct ASTNode* right;
-    struct ASTNode* next;
-} ASTNode;
+} PendingOperator;
 
-// 分析步骤记录
+// 语法分析器：一次分析的全部状态。每个线程用自己的Parser就可以同时分析不同的文件
+// （驻留池和字面量表本身是多线程共用的）
 typedef struct {
-    int step;
-    char stack[200];
-    char input[200];
-    char action[100];
-    int depth;
-} ParseStep;
+    // 输入：一次分析好的Token序列，或流水线模式下的Token管道
+    TokenStream* tokens;
+    TokenPipe* pipe;
+    uint32_t token_index;       // 当前Token的编号
+    Token current_token;
+    char lexeme[256];           // 取当前Token文本用的缓冲区
+    
+    Ast* ast;                   // 语法树（第一次分析时创建，之后的分析重用）
+    AstId root;
+    int depth;                  // 递归深度（表达式中每层括号也算一层）
+    
+    // 表达式分析用的显式栈
+    AstId* operands;
+    uint32_t operand_count;
+    uint32_t operand_capacity;
+    PendingOperator* operators;
+    uint32_t operator_count;
+    uint32_t operator_capacity;
+    
+    TraceLevel trace_level;     // 下一次分析使用的跟踪级别
+    ParseTrace trace;           // 分析过程
+    
+    // 收集到的语法错误；panic_mode表示上一个错误之后还没有恢复（期间的错误不再记录）
+    SyntaxDiagnostic* diagnostics;
+    uint32_t diagnostic_count;
+    uint32_t diagnostic_capacity;
+    int panic_mode;
+} Parser;
 
-// 全局变量声明
-extern Token current_token;
-extern ASTNode* ast_root;
-extern ParseStep steps[MAX_STEPS];
-extern int step_count;
-extern int parse_depth;
+// 创建和销毁（内存不足时返回NULL）
+Parser* parser_create();
+void parser_destroy(Parser* p);
 
 // 语法分析函数
-void parse_program();
-ASTNode* parse_block();
-ASTNode* parse_statement();
-ASTNode* parse_assignment();
-ASTNode* parse_if();
-ASTNode* parse_while();
-ASTNode* parse_expression();
-ASTNode* parse_term();
-ASTNode* parse_factor();
-ASTNode* parse_condition();
+void parser_set_trace_level(Parser* p, TraceLevel level);  // 默认为编译时允许的最高级别PARSE_TRACE_MAX
+void parser_init(Parser* p, TokenStream* tokens);
+void parser_init_pipe(Parser* p, TokenPipe* pipe);         // 流水线模式：词法分析在另一个线程进行
+void parser_parse_program(Parser* p);
+AstId parser_parse_block(Parser* p);
+AstId parser_parse_statement(Parser* p);
+AstId parser_parse_assignment(Parser* p);
+AstId parser_parse_if(Parser* p);
+AstId parser_parse_while(Parser* p);
+AstId parser_parse_expression(Parser* p);
+AstId parser_parse_condition(Parser* p);
 
 // 工具函数
-ASTNode* create_node(NodeType type, const char* value, int line, int col);
-void add_step(const char* stack, const char* input, const char* action);
+AstId parser_create_node(Parser* p, NodeType type, int line, int col);
+void parser_match(Parser* p, TokenType expected);
+void parser_syntax_error(Parser* p, const char* message);
+const SyntaxDiagnostic* parser_diagnostics(const Parser* p, uint32_t* count);
+void parser_display(const Parser* p);                      // 显示分析过程和语法树
+void parser_save_result(const Parser* p, const char* filename);
+
+// 全局函数声明（使用默认分析器，兼容旧代码）
+extern Ast* ast;                // 默认分析器的语法树（parse_program之后有效，free_ast释放）
+extern AstId ast_root;
+
+void set_trace_level(TraceLevel level);
+void init_parser(TokenStream* tokens);
+void init_parser_pipe(TokenPipe* pipe);
+void parse_program();
+AstId parse_block();
+AstId parse_statement();
+AstId parse_assignment();
+AstId parse_if();
+AstId parse_while();
+AstId parse_expression();
+AstId parse_condition();
+AstId create_node(NodeType type, int line, int col);
 void display_parse_process();
 void save_result(const char* filename);
-void print_ast(ASTNode* node, int depth);
-void free_ast(ASTNode* node);
-
-// 语法检查函数
+const SyntaxDiagnostic* get_syntax_diagnostics(uint32_t* count);
+void print_ast(AstId node, int depth);
+void free_ast();                // 释放语法树、分析过程记录和语法错误
 void match(TokenType expected);
 void syntax_error(const char* message);
 
@@ -0,0 +1,158 @@
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 进入/退出各非终结符的文本
+static const TraceText enter_texts[SYM_COUNT] = {
+    [SYM_PROGRAM] = { "parse_program", "开始", "程序分析开始" },
+    [SYM_BLOCK] = { "parse_block", NULL, "进入block分析" },
+    [SYM_STATEMENT] = { "parse_statement", NULL, "进入statement分析" },
+    [SYM_ASSIGNMENT] = { "parse_assignment", NULL, "进入assignment分析" },
+    [SYM_IF] = { "parse_if", NULL, "进入if分析" },
+    [SYM_WHILE] = { "parse_while", NULL, "进入while分析" },
+    [SYM_CONDITION] = { "parse_condition", NULL, "进入condition分析" },
+    [SYM_EXPRESSION] = { "parse_expression", NULL, "进入expression分析" },
+};
+
+static const TraceText exit_texts[SYM_COUNT] = {
+    [SYM_PROGRAM] = { "parse_program", "完成", "程序分析完成" },
+    [SYM_BLOCK] = { "parse_block", "完成", "退出block分析" },
+    [SYM_STATEMENT] = { "parse_statement", "完成", "退出statement分析" },
+    [SYM_ASSIGNMENT] = { "parse_assignment", "完成", "退出assignment分析" },
+    [SYM_IF] = { "parse_if", "完成", "退出if分析" },
+    [SYM_WHILE] = { "parse_while", "完成", "退出while分析" },
+    [SYM_CONDITION] = { "parse_condition", "完成", "退出condition分析" },
+    [SYM_EXPRESSION] = { "parse_expression", "完成", "退出expression分析" },
+};
+
+// 各产生式的文本
+static const TraceText rule_texts[RULE_COUNT] = {
+    [RULE_FACTOR_ID] = { "factor → ID", NULL, "识别标识符" },
+    [RULE_FACTOR_NUM] = { "factor → NUM", NULL, "识别数字" },
+    [RULE_FACTOR_STR] = { "factor → STRING", NULL, "识别字符串" },
+    [RULE_FACTOR_PAREN] = { "factor → ( expression )", "(", "识别括号表达式" },
+    [RULE_TERM_MUL] = { "term → term * factor", "*", "识别乘法" },
+    [RULE_TERM_DIV] = { "term → term / factor", "/", "识别除法" },
+    [RULE_EXPRESSION_ADD] = { "expression → expression + term", "+", "识别加法" },
+    [RULE_EXPRESSION_SUB] = { "expression → expression - term", "-", "识别减法" },
+    [RULE_CONDITION_RELOP] = { "condition → expression relop expression", NULL, "识别关系表达式" },
+    [RULE_CONDITION_SIMPLE] = { "condition → expression", "简单条件", "无关系运算符" },
+    [RULE_ASSIGNMENT] = { "assignment → ID = expression ;", NULL, "识别赋值语句" },
+    [RULE_IF_ELSE] = { "if → if ... else statement", "else", "识别else分支" },
+};
+
+// 开始新的一次跟踪
+void trace_start(ParseTrace* trace, TraceLevel level, int keep_tokens) {
+    trace->level = level;
+    trace->total = 0;
+    trace->keep_tokens = keep_tokens;
+    if (keep_tokens && trace->capacity && !trace->tokens) {
+        trace->tokens = (Token*)malloc(trace->capacity * sizeof(Token));
+        if (!trace->tokens && level == TRACE_FULL) trace->level = TRACE_SUMMARY;
+    }
+    memset(trace->symbol_counts, 0, sizeof(trace->symbol_counts));
+    memset(trace->rule_counts, 0, sizeof(trace->rule_counts));
+    trace->match_count = 0;
+    trace->skip_count = 0;
+    trace->max_depth = 0;
+}
+
+void trace_free(ParseTrace* trace) {
+    free(trace->events);
+    free(trace->tokens);
+    trace->events = NULL;
+    trace->tokens = NULL;
+    trace->capacity = 0;
+    trace->total = 0;
+}
+
+// 缓冲区容量加倍（还没有回绕，原有的内容位置不变）
+static int grow(ParseTrace* trace) {
+    uint32_t capacity = trace->capacity ? trace->capacity * 2 : TRACE_INITIAL_EVENTS;
+    TraceEvent* events = (TraceEvent*)realloc(trace->events, capacity * sizeof(TraceEvent));
+    if (!events) return 0;
+    trace->events = events;
+    if (trace->keep_tokens || trace->tokens) {
+        Token* tokens = (Token*)realloc(trace->tokens, capacity * sizeof(Token));
+        if (!tokens) return 0;
+        trace->tokens = tokens;
+    }
+    trace->capacity = capacity;
+    return 1;
+}
+
+// 记录事件
+int trace_record(ParseTrace* trace, TraceEventKind kind, int production, int depth, uint32_t token) {
+    if (depth > trace->max_depth) trace->max_depth = depth;
+    switch (kind) {
+        case EVENT_ENTER: trace->symbol_counts[production]++; break;
+        case EVENT_RULE: trace->rule_counts[production]++; break;
+        case EVENT_MATCH: trace->match_count++; break;
+        case EVENT_SKIP: trace->skip_count++; break;
+        default: break;
+    }
+    if (trace->level < TRACE_FULL) return 1;
+    
+    if (trace->total >= trace->capacity && trace->capacity < TRACE_MAX_EVENTS && !grow(trace)) {
+        trace->level = TRACE_SUMMARY;
+        return 0;
+    }
+    
+    TraceEvent* event = &trace->events[trace->total & (trace->capacity - 1)];
+    event->kind = (uint8_t)kind;
+    event->production = (uint8_t)production;
+    event->depth = depth > UINT16_MAX ? UINT16_MAX : (uint16_t)depth;
+    event->token = token;
+    trace->total++;
+    return 1;
+}
+
+// 保存Token：每前进一个Token都有一个匹配或跳过事件，引用某个Token的事件之后至少还有那么多个事件，
+// 所以事件还保留着的话Token也还在
+int trace_token(ParseTrace* trace, uint32_t index, Token token) {
+    if (trace->level < TRACE_FULL) return 1;
+    while (index >= trace->capacity && trace->capacity < TRACE_MAX_EVENTS) {
+        if (!grow(trace)) {
+            trace->level = TRACE_SUMMARY;
+            return 0;
+        }
+    }
+    trace->tokens[index & (trace->capacity - 1)] = token;
+    return 1;
+}
+
+// 保留的第一个事件的序号
+uint64_t trace_first(const ParseTrace* trace) {
+    return trace->total > trace->capacity ? trace->total - trace->capacity : 0;
+}
+
+const TraceEvent* trace_get(const ParseTrace* trace, uint64_t sequence) {
+    return &trace->events[sequence & (trace->capacity - 1)];
+}
+
+Token trace_token_at(const ParseTrace* trace, uint32_t index) {
+    return trace->tokens[index & (trace->capacity - 1)];
+}
+
+// 事件的文本
+TraceText trace_text(const TraceEvent* event) {
+    switch ((TraceEventKind)event->kind) {
+        case EVENT_ENTER: return enter_texts[event->production];
+        case EVENT_EXIT: return exit_texts[event->production];
+        case EVENT_RULE: return rule_texts[event->production];
+        default: return (TraceText){ "", "", "" };
+    }
+}
+
+static const char* level_names[] = { "off", "summary", "full" };
+
+const char* trace_level_name(TraceLevel level) {
+    return level_names[level];
+}
+
+int trace_level_from_name(const char* name) {
+    for (int level = TRACE_OFF; level <= TRACE_FULL; level++) {
+        if (strcmp(name, level_names[level]) == 0) return level;
+    }
+    return -1;
+}
@@ -0,0 +1,128 @@
+#ifndef PARSE_TRACE_H
+#define PARSE_TRACE_H
+
+#include <stdint.h>
+#include "../../lexical_analyzer/scanner.h"
+
+// 分析过程跟踪：语法分析时只记录8字节的二进制事件（类型、产生式、深度、Token编号），
+// 显示分析过程时才把事件格式化成文本。
+//   TRACE_OFF      不记录
+//   TRACE_SUMMARY  只统计各产生式的使用次数和最大深度
+//   TRACE_FULL     记录每个事件；事件放在环形缓冲区中，缓冲区按需加倍，
+//                  到TRACE_MAX_EVENTS后不再扩大，只保留最后这么多个事件
+// 编译时加 -DPARSE_TRACE_MAX=TRACE_OFF 可以去掉所有跟踪代码。
+
+typedef enum {
+    TRACE_OFF,
+    TRACE_SUMMARY,
+    TRACE_FULL
+} TraceLevel;
+
+#ifndef PARSE_TRACE_MAX
+#define PARSE_TRACE_MAX TRACE_FULL
+#endif
+
+#define TRACE_INITIAL_EVENTS 1024
+#define TRACE_MAX_EVENTS (1u << 16)     // 2的幂
+
+// 事件类型
+typedef enum {
+    EVENT_ENTER,    // 进入非终结符的分析函数
+    EVENT_EXIT,     // 退出分析函数
+    EVENT_RULE,     // 选定产生式
+    EVENT_MATCH,    // 匹配终结符
+    EVENT_SKIP      // 错误恢复时跳过终结符
+} TraceEventKind;
+
+// 非终结符
+typedef enum {
+    SYM_PROGRAM,
+    SYM_BLOCK,
+    SYM_STATEMENT,
+    SYM_ASSIGNMENT,
+    SYM_IF,
+    SYM_WHILE,
+    SYM_CONDITION,
+    SYM_EXPRESSION,
+    SYM_COUNT
+} TraceSymbol;
+
+// 产生式
+typedef enum {
+    RULE_FACTOR_ID,
+    RULE_FACTOR_NUM,
+    RULE_FACTOR_STR,
+    RULE_FACTOR_PAREN,
+    RULE_TERM_MUL,
+    RULE_TERM_DIV,
+    RULE_EXPRESSION_ADD,
+    RULE_EXPRESSION_SUB,
+    RULE_CONDITION_RELOP,
+    RULE_CONDITION_SIMPLE,
+    RULE_ASSIGNMENT,
+    RULE_IF_ELSE,
+    RULE_COUNT
+} TraceRule;
+
+typedef struct {
+    uint8_t kind;           // TraceEventKind
+    uint8_t production;     // ENTER/EXIT：TraceSymbol，RULE：TraceRule，MATCH：期望的TokenType，SKIP：跳过的TokenType
+    uint16_t depth;         // 递归深度
+    uint32_t token;         // 当时的Token编号
+} TraceEvent;
+
+// 事件的三列文本（input为NULL表示取事件所在Token的文本）
+typedef struct {
+    const char* stack;
+    const char* input;
+    const char* action;
+} TraceText;
+
+typedef struct {
+    TraceLevel level;
+    
+    // TRACE_FULL：事件环形缓冲区，第i个事件（从0数）在events[i & (capacity - 1)]
+    TraceEvent* events;
+    uint32_t capacity;
+    uint64_t total;         // 记录过的事件总数
+    
+    // 流水线模式下Token取出后就不能再按编号读取，按同样的方式保留最近的Token
+    Token* tokens;
+    int keep_tokens;
+    
+    // TRACE_SUMMARY及以上：统计
+    uint64_t symbol_counts[SYM_COUNT];
+    uint64_t rule_counts[RULE_COUNT];
+    uint64_t match_count;
+    uint64_t skip_count;
+    int max_depth;
+} ParseTrace;
+
+// 开始新的一次跟踪（保留已分配的缓冲区）；keep_tokens表示需要用trace_token保存Token
+void trace_start(ParseTrace* trace, TraceLevel level, int keep_tokens);
+
+void trace_free(ParseTrace* trace);
+
+// 记录事件（只在level不是TRACE_OFF时调用）；TRACE_FULL下内存不足时停止记录，返回0
+int trace_record(ParseTrace* trace, TraceEventKind kind, int production, int depth, uint32_t token);
+
+// 保存第index个Token（keep_tokens时在Token成为当前Token时调用）
+// 分析器每前进一个Token都要记录一个MATCH或SKIP事件，这样事件还保留着时它引用的Token也还在；内存不足时同样降为TRACE_SUMMARY，返回0
+int trace_token(ParseTrace* trace, uint32_t index, Token token);
+
+// 保留的第一个事件的序号；事件序号是[trace_first, total)
+uint64_t trace_first(const ParseTrace* trace);
+
+const TraceEvent* trace_get(const ParseTrace* trace, uint64_t sequence);
+
+// 保留的第index个Token
+Token trace_token_at(const ParseTrace* trace, uint32_t index);
+
+// ENTER/EXIT/RULE事件的文本
+TraceText trace_text(const TraceEvent* event);
+
+// 级别名（"off"、"summary"、"full"），以及按名字查级别（不认识时返回-1）
+const char* trace_level_name(TraceLevel level);
+int trace_level_from_name(const char* name);
+
+#endif
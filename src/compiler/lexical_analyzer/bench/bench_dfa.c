@@ -0,0 +1,187 @@
+// DFA转移表微基准：原来手写的转移表 vs gen_lexer生成的最小化转移表
+// 用法: bench_dfa [MB数] [轮数]
+//
+// 两组表用同一个最长匹配驱动循环（不含标识符批量内核和Unicode处理），
+// 只比较查表本身的开销；两组表识别出的Token序列必须一致。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../scanner.h"
+#include "../lexer_tables.h"
+#include "corpus.h"
+
+// ==================== 原来手写的转移表 ====================
+
+// 字符类别（与locale无关，非ASCII字节归入CC_OTHER，由扫描器另行解码）
+enum {
+    CC_OTHER,       // 其他字符（非法）
+    CC_SPACE,       // 空白
+    CC_LETTER,      // 字母和下划线
+    CC_DIGIT,       // 数字
+    CC_DOT,         // .
+    CC_QUOTE,       // "
+    CC_BACKSLASH,   // 反斜杠（与CC_QUOTE相邻，见S_STRING的转移）
+    CC_PLUS, CC_MINUS, CC_STAR, CC_SLASH,
+    CC_EQ, CC_LT, CC_GT, CC_BANG,
+    CC_LPAREN, CC_RPAREN, CC_LBRACE, CC_RBRACE,
+    CC_SEMI, CC_COMMA, CC_COLON,
+    CC_COUNT
+};
+
+// 字符 → 类别
+static const unsigned char char_class[256] = {
+    [' '] = CC_SPACE, ['\t' ... '\r'] = CC_SPACE,
+    ['a' ... 'z'] = CC_LETTER, ['A' ... 'Z'] = CC_LETTER, ['_'] = CC_LETTER,
+    ['0' ... '9'] = CC_DIGIT,
+    ['.'] = CC_DOT, ['"'] = CC_QUOTE, ['\\'] = CC_BACKSLASH,
+    ['+'] = CC_PLUS, ['-'] = CC_MINUS, ['*'] = CC_STAR, ['/'] = CC_SLASH,
+    ['='] = CC_EQ, ['<'] = CC_LT, ['>'] = CC_GT, ['!'] = CC_BANG,
+    ['('] = CC_LPAREN, [')'] = CC_RPAREN, ['{'] = CC_LBRACE, ['}'] = CC_RBRACE,
+    [';'] = CC_SEMI, [','] = CC_COMMA, [':'] = CC_COLON,
+};
+
+// DFA状态（S_STOP表示没有转移，Token在此结束）
+enum {
+    S_STOP,
+    S_START,
+    S_IDENT,        // 标识符/关键字
+    S_INT,          // 整数部分
+    S_FRAC,         // 小数点及小数部分
+    S_STRING,       // 字符串内部
+    S_STRING_ESC,   // 字符串中的转义字符
+    S_STRING_END,   // 字符串结束
+    S_PLUS, S_MINUS, S_STAR, S_SLASH,
+    S_ASSIGN, S_EQ,
+    S_LT, S_LE, S_LT_GT,
+    S_GT, S_GE,
+    S_BANG, S_NE,
+    S_LPAREN, S_RPAREN, S_LBRACE, S_RBRACE,
+    S_SEMI, S_COMMA, S_COLON,
+    S_COUNT
+};
+
+// 状态转移表：dfa_next[状态][字符类别]，未列出的为S_STOP
+static const unsigned char dfa_next[S_COUNT][CC_COUNT] = {
+    [S_START] = {
+        [CC_LETTER] = S_IDENT, [CC_DIGIT] = S_INT, [CC_QUOTE] = S_STRING,
+        [CC_PLUS] = S_PLUS, [CC_MINUS] = S_MINUS, [CC_STAR] = S_STAR, [CC_SLASH] = S_SLASH,
+        [CC_EQ] = S_ASSIGN, [CC_LT] = S_LT, [CC_GT] = S_GT, [CC_BANG] = S_BANG,
+        [CC_LPAREN] = S_LPAREN, [CC_RPAREN] = S_RPAREN,
+        [CC_LBRACE] = S_LBRACE, [CC_RBRACE] = S_RBRACE,
+        [CC_SEMI] = S_SEMI, [CC_COMMA] = S_COMMA, [CC_COLON] = S_COLON,
+    },
+    [S_IDENT] = { [CC_LETTER] = S_IDENT, [CC_DIGIT] = S_IDENT },
+    [S_INT] = { [CC_DIGIT] = S_INT, [CC_DOT] = S_FRAC },
+    [S_FRAC] = { [CC_DIGIT] = S_FRAC },
+    [S_STRING] = {
+        [0 ... CC_QUOTE - 1] = S_STRING,
+        [CC_QUOTE] = S_STRING_END, [CC_BACKSLASH] = S_STRING_ESC,
+        [CC_BACKSLASH + 1 ... CC_COUNT - 1] = S_STRING,
+    },
+    [S_STRING_ESC] = { [0 ... CC_COUNT - 1] = S_STRING },
+    [S_ASSIGN] = { [CC_EQ] = S_EQ },
+    [S_LT] = { [CC_EQ] = S_LE, [CC_GT] = S_LT_GT },
+    [S_GT] = { [CC_EQ] = S_GE },
+    [S_BANG] = { [CC_EQ] = S_NE },
+};
+
+// 接受状态对应的Token类型，0表示不是接受状态
+static const TokenType dfa_accept[S_COUNT] = {
+    [S_IDENT] = TK_ID, [S_INT] = TK_NUM, [S_FRAC] = TK_NUM, [S_STRING_END] = TK_STR,
+    [S_PLUS] = TK_PLUS, [S_MINUS] = TK_MINUS, [S_STAR] = TK_MUL, [S_SLASH] = TK_DIV,
+    [S_ASSIGN] = TK_ASSIGN, [S_EQ] = TK_EQ,
+    [S_LT] = TK_LT, [S_LE] = TK_LE, [S_LT_GT] = TK_NE,
+    [S_GT] = TK_GT, [S_GE] = TK_GE, [S_NE] = TK_NE,
+    [S_LPAREN] = TK_LPAREN, [S_RPAREN] = TK_RPAREN,
+    [S_LBRACE] = TK_LBRACE, [S_RBRACE] = TK_RBRACE,
+    [S_SEMI] = TK_SEMICOLON, [S_COMMA] = TK_COMMA, [S_COLON] = TK_COLON,
+};
+
+// ==================== 驱动循环 ====================
+
+// 一组DFA表（转移表按行展开，每行classes项）
+typedef struct {
+    const unsigned char* byte_class;
+    const unsigned char* next;
+    int classes;
+    const TokenType* accept;
+} DfaTables;
+
+static const DfaTables handwritten = { char_class, &dfa_next[0][0], CC_COUNT, dfa_accept };
+static const DfaTables generated = { lexer_class, &lexer_next[0][0], LEXER_CLASSES, lexer_accept };
+
+static int is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// 跳过空白后反复做最长匹配，返回Token数；checksum累计各Token的类型和长度
+static unsigned long scan(const DfaTables* t, const char* text, size_t length, unsigned long* checksum) {
+    const unsigned char* p = (const unsigned char*)text;
+    const unsigned char* end = p + length;
+    unsigned long count = 0, sum = 0;
+    while (1) {
+        while (p < end && is_space(*p)) p++;
+        if (p == end) break;
+        const unsigned char* start = p;
+        int state = 1;
+        while (p < end) {
+            int next = t->next[state * t->classes + t->byte_class[*p]];
+            if (next == 0) break;
+            state = next;
+            p++;
+        }
+        if (p == start) p++;    // 非法字符
+        sum = sum * 31 + (unsigned long)t->accept[state] * 1000 + (unsigned long)(p - start);
+        count++;
+    }
+    *checksum = sum;
+    return count;
+}
+
+// 运行多轮，返回最快一轮的秒数
+static double run(const DfaTables* t, const char* text, size_t length, int rounds,
+                  unsigned long* tokens, unsigned long* checksum) {
+    double best = 0;
+    for (int r = 0; r < rounds; r++) {
+        clock_t start = clock();
+        *tokens = scan(t, text, length, checksum);
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (r == 0 || seconds < best) best = seconds;
+    }
+    return best > 0 ? best : 1e-9;
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 16;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    if (rounds < 1) rounds = 1;
+
+    CorpusMix mix;
+    corpus_default_mix(&mix);
+    size_t length;
+    char* text = corpus_generate(megabytes << 20, &mix, 12345u, &length);
+    if (!text) {
+        printf("错误：内存不足\n");
+        return 1;
+    }
+
+    unsigned long old_tokens, new_tokens, old_sum, new_sum;
+    double old_time = run(&handwritten, text, length, rounds, &old_tokens, &old_sum);
+    double new_time = run(&generated, text, length, rounds, &new_tokens, &new_sum);
+    if (old_tokens != new_tokens || old_sum != new_sum) {
+        printf("错误：两组转移表识别出的Token不一致\n");
+        free(text);
+        return 1;
+    }
+
+    printf("DFA转移表基准（合成 %zu 字节，%lu 个Token，%d 轮取最快）\n", length, new_tokens, rounds);
+    printf("%-14s %3d 个状态 x %2d 个类别 %8.1f MB/s\n", "手写", (int)S_COUNT, (int)CC_COUNT,
+           (double)length / old_time / 1e6);
+    printf("%-14s %3d 个状态 x %2d 个类别 %8.1f MB/s\n", "生成", LEXER_STATES, LEXER_CLASSES,
+           (double)length / new_time / 1e6);
+    printf("加速比: %.2fx\n", old_time / new_time);
+
+    free(text);
+    return 0;
+}
@@ -0,0 +1,96 @@
+// 关键字识别微基准：线性strcmp查表 vs 生成的完美哈希
+// 用法: bench_keywords [单词数] [轮数]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../scanner.h"
+#include "../keyword_hash.h"
+
+// 原来的线性关键字表
+static const struct {
+    const char* word;
+    TokenType type;
+} linear_keywords[] = {
+    {"begin", TK_BEGIN}, {"end", TK_END}, {"if", TK_IF}, {"then", TK_THEN},
+    {"else", TK_ELSE}, {"while", TK_WHILE}, {"do", TK_DO}, {"for", TK_FOR},
+    {"switch", TK_SWITCH}, {"case", TK_CASE}, {"default", TK_DEFAULT},
+    {"true", TK_TRUE}, {"false", TK_FALSE}, {NULL, TK_ERROR}
+};
+
+// 原来的查找方式（逐个strcmp）
+static TokenType linear_lookup(const char* word) {
+    for (int i = 0; linear_keywords[i].word != NULL; i++) {
+        if (strcmp(word, linear_keywords[i].word) == 0) {
+            return linear_keywords[i].type;
+        }
+    }
+    return TK_ID;
+}
+
+// 测试用单词：关键字、普通标识符以及与关键字长度首尾相同的干扰词
+static const char* vocabulary[] = {
+    "begin", "end", "if", "then", "else", "while", "do", "for",
+    "switch", "case", "default", "true", "false",
+    "x", "y", "z", "i", "j", "count", "sum", "result", "value", "index",
+    "total", "buffer", "length", "node", "temp", "flag", "counter",
+    "bin", "efd", "iff", "then_", "eXe", "whale", "dgo", "fur",
+    "stitch", "cave", "defunct", "tree", "fable", "beginning", "ending",
+    "do_work", "is_true", "elsewhere", "forward", "x1", "y2", "loop_var",
+};
+
+#define VOCAB_SIZE ((int)(sizeof(vocabulary) / sizeof(vocabulary[0])))
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[]) {
+    int word_count = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    // 用固定种子生成单词序列，保证每次运行结果可比
+    const char** words = (const char**)malloc(sizeof(char*) * word_count);
+    size_t* lengths = (size_t*)malloc(sizeof(size_t) * word_count);
+    unsigned seed = 12345;
+    for (int i = 0; i < word_count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        words[i] = vocabulary[(seed >> 16) % VOCAB_SIZE];
+        lengths[i] = strlen(words[i]);
+    }
+
+    // 两种实现的结果必须一致
+    for (int i = 0; i < VOCAB_SIZE; i++) {
+        if (linear_lookup(vocabulary[i]) != keyword_lookup(vocabulary[i], strlen(vocabulary[i]))) {
+            printf("错误：'%s' 的识别结果不一致\n", vocabulary[i]);
+            return 1;
+        }
+    }
+
+    unsigned long checksum = 0;
+    clock_t start = clock();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < word_count; i++) {
+            checksum += linear_lookup(words[i]);
+        }
+    }
+    double linear_time = seconds_since(start);
+
+    start = clock();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < word_count; i++) {
+            checksum -= keyword_lookup(words[i], lengths[i]);
+        }
+    }
+    double hash_time = seconds_since(start);
+
+    double total = (double)word_count * rounds;
+    printf("关键字识别基准（%d 个单词 x %d 轮）\n", word_count, rounds);
+    printf("%-14s %10.3f s %10.1f M次/秒\n", "线性strcmp", linear_time, total / linear_time / 1e6);
+    printf("%-14s %10.3f s %10.1f M次/秒\n", "完美哈希", hash_time, total / hash_time / 1e6);
+    printf("加速比: %.2fx\n", linear_time / hash_time);
+
+    free(words);
+    free(lengths);
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// 词法分析吞吐量基准
+// 用法: bench_lexer [MB数] [轮数] [比例] [种子]
+//       bench_lexer -f 文件名 [轮数]
+//
+// 不输出任何Token，只统计扫描时间。每种方式运行多轮取最快一轮，
+// 语料由固定种子生成，同样的参数在不同提交之间的结果可以直接比较。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../scanner.h"
+#include "../token_stream.h"
+#include "corpus.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+// 一轮的计时结果
+typedef struct {
+    double seconds;
+    double cycles;          // 时间戳计数器的计数（不支持时为0）
+    unsigned long tokens;
+} BenchResult;
+
+static unsigned long long read_cycles() {
+#ifdef HAVE_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 逐个取Token
+static unsigned long scan_tokens(const char* text, size_t length) {
+    Scanner* s = scanner_create(text, length);
+    unsigned long count = 0;
+    Token token;
+    do {
+        token = scanner_next_token(s);
+        count++;
+    } while (token.type != TK_EOF);
+    scanner_destroy(s);
+    return count;
+}
+
+// 一次性分析成TokenStream
+static unsigned long scan_stream(const char* text, size_t length) {
+    TokenStream* ts = tokenize_all(text, length);
+    unsigned long count = ts ? ts->count : 0;
+    token_stream_destroy(ts);
+    return count;
+}
+
+// 运行多轮，保留最快的一轮
+static BenchResult run(unsigned long (*scan)(const char*, size_t),
+                       const char* text, size_t length, int rounds) {
+    BenchResult best = { 0, 0, 0 };
+    for (int r = 0; r < rounds; r++) {
+        clock_t start = clock();
+        unsigned long long start_cycles = read_cycles();
+        unsigned long tokens = scan(text, length);
+        double cycles = (double)(read_cycles() - start_cycles);
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (r == 0 || seconds < best.seconds) {
+            best.seconds = seconds;
+            best.cycles = cycles;
+            best.tokens = tokens;
+        }
+    }
+    return best;
+}
+
+static void report(const char* name, BenchResult result, size_t length) {
+    double seconds = result.seconds > 0 ? result.seconds : 1e-9;
+    printf("%-20s %8.1f MB/s %8.2f M tokens/s", name,
+           (double)length / seconds / 1e6, (double)result.tokens / seconds / 1e6);
+    if (result.cycles > 0) {
+        printf(" %6.2f cycles/byte", result.cycles / (double)length);
+    }
+    printf("\n");
+}
+
+// 读入整个文件
+static char* read_file(const char* filename, size_t* length) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (char*)malloc((size_t)size + 1);
+    if (text) {
+        *length = fread(text, 1, (size_t)size, file);
+        text[*length] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    char* text;
+    size_t length;
+    int rounds;
+
+    if (argc > 2 && strcmp(argv[1], "-f") == 0) {
+        rounds = argc > 3 ? atoi(argv[3]) : 5;
+        text = read_file(argv[2], &length);
+        if (!text) {
+            printf("错误：无法读取文件 %s\n", argv[2]);
+            return 1;
+        }
+        printf("语料: %s, %zu 字节\n", argv[2], length);
+    } else {
+        size_t megabytes = argc > 1 ? (size_t)atoi(argv[1]) : 16;
+        rounds = argc > 2 ? atoi(argv[2]) : 5;
+        unsigned seed = argc > 4 ? (unsigned)strtoul(argv[4], NULL, 10) : 12345u;
+
+        CorpusMix mix;
+        corpus_default_mix(&mix);
+        if (argc > 3 && !corpus_parse_mix(argv[3], &mix)) {
+            printf("错误：无法解析比例 %s\n", argv[3]);
+            return 1;
+        }
+        text = corpus_generate(megabytes << 20, &mix, seed, &length);
+        if (!text) {
+            printf("错误：内存不足\n");
+            return 1;
+        }
+        printf("语料: 合成 %zu 字节, 种子 %u, 比例 ", length, seed);
+        corpus_print_mix(&mix);
+        printf("\n");
+    }
+    if (rounds < 1) rounds = 1;
+
+    printf("扫描内核: %s, 每项 %d 轮取最快\n\n", scan_kernels_detect()->name, rounds);
+
+    // 预热一次，让页面和驻留池都就绪
+    scan_tokens(text, length);
+
+    report("scanner_next_token", run(scan_tokens, text, length, rounds), length);
+    report("tokenize_all", run(scan_stream, text, length, rounds), length);
+
+    free(text);
+    return 0;
+}
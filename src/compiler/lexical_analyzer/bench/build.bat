@@ -0,0 +1,28 @@
+@echo off
+chcp 65001 > nul
+echo ========================================
+echo   编译词法分析器性能基准
+echo ========================================
+echo.
+
+echo [1/4] 编译关键字识别和DFA转移表基准...
+gcc -O2 bench_keywords.c -o bench_keywords.exe
+gcc -O2 -I.. bench_dfa.c corpus.c -o bench_dfa.exe
+
+echo [2/4] 编译语料生成器和吞吐量基准...
+gcc -O2 gen_corpus.c corpus.c -o gen_corpus.exe
+gcc -O2 -I.. bench_lexer.c corpus.c ../scanner.c ../scan_simd.c ../unicode.c ../intern.c ../literal.c ../token_stream.c ../token_cache.c -o bench_lexer.exe -lpthread
+
+echo [3/4] 运行关键字识别和DFA转移表基准...
+echo.
+bench_keywords.exe
+echo.
+bench_dfa.exe 16 5
+
+echo.
+echo [4/4] 运行吞吐量基准（16MB合成语料，固定种子）...
+echo.
+bench_lexer.exe 16 5
+
+echo.
+pause
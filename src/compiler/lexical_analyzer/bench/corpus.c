@@ -0,0 +1,168 @@
+#include "corpus.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 各类别在比例字符串中的名字
+static const char* piece_names[PIECE_COUNT] = {
+    "ident", "kw", "int", "float", "str", "comment", "op"
+};
+
+static const char* keywords[] = {
+    "begin", "end", "if", "then", "else", "while", "do", "for",
+    "switch", "case", "default", "true", "false"
+};
+
+static const char* operators[] = {
+    "+", "-", "*", "/", "=", "==", "<", "<=", "<>", ">", ">=", "!=",
+    "(", ")", "{", "}", ";", ",", ":"
+};
+
+static const char ident_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+// 线性同余随机数（与bench_keywords相同，跨平台结果一致）
+static unsigned next_random(unsigned* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7FFF;
+}
+
+// 默认比例
+void corpus_default_mix(CorpusMix* mix) {
+    static const unsigned defaults[PIECE_COUNT] = { 30, 15, 10, 5, 5, 5, 30 };
+    memcpy(mix->weight, defaults, sizeof(defaults));
+}
+
+// 解析比例字符串
+int corpus_parse_mix(const char* spec, CorpusMix* mix) {
+    memset(mix, 0, sizeof(*mix));
+
+    const char* p = spec;
+    while (*p) {
+        int kind = -1;
+        for (int i = 0; i < PIECE_COUNT; i++) {
+            size_t n = strlen(piece_names[i]);
+            if (strncmp(p, piece_names[i], n) == 0 && p[n] == '=') {
+                kind = i;
+                p += n + 1;
+                break;
+            }
+        }
+        if (kind < 0) return 0;
+
+        char* end;
+        mix->weight[kind] = (unsigned)strtoul(p, &end, 10);
+        if (end == p) return 0;
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    unsigned total = 0;
+    for (int i = 0; i < PIECE_COUNT; i++) total += mix->weight[i];
+    return total > 0;
+}
+
+// 打印比例
+void corpus_print_mix(const CorpusMix* mix) {
+    for (int i = 0; i < PIECE_COUNT; i++) {
+        printf("%s%s=%u", i ? "," : "", piece_names[i], mix->weight[i]);
+    }
+}
+
+// 按权重选一个类别
+static PieceKind pick_kind(const CorpusMix* mix, unsigned total, unsigned* seed) {
+    unsigned r = ((next_random(seed) << 15) | next_random(seed)) % total;
+    for (int i = 0; i < PIECE_COUNT; i++) {
+        if (r < mix->weight[i]) return (PieceKind)i;
+        r -= mix->weight[i];
+    }
+    return PIECE_OPERATOR;
+}
+
+// 追加一个Token的文本，返回写入的字节数（out至少留有64字节）
+static int write_piece(char* out, PieceKind kind, unsigned* seed) {
+    int n = 0;
+    switch (kind) {
+        case PIECE_IDENT: {
+            int length = 1 + (int)(next_random(seed) % 12);
+            out[n++] = ident_chars[next_random(seed) % 53];     // 首字符不是数字
+            while (n < length) out[n++] = ident_chars[next_random(seed) % 63];
+            break;
+        }
+        case PIECE_KEYWORD: {
+            const char* word = keywords[next_random(seed) % COUNT_OF(keywords)];
+            n = (int)strlen(word);
+            memcpy(out, word, (size_t)n);
+            break;
+        }
+        case PIECE_INT:
+            n = sprintf(out, "%u", next_random(seed) % 100000);
+            break;
+        case PIECE_FLOAT:
+            n = sprintf(out, "%u.%u", next_random(seed) % 1000, next_random(seed) % 10000);
+            break;
+        case PIECE_STRING: {
+            int length = (int)(next_random(seed) % 24);
+            out[n++] = '"';
+            for (int i = 0; i < length; i++) {
+                out[n++] = (next_random(seed) % 6 == 0) ? ' ' : ident_chars[next_random(seed) % 52];
+            }
+            out[n++] = '"';
+            break;
+        }
+        case PIECE_COMMENT: {
+            int length = 4 + (int)(next_random(seed) % 40);
+            int block = next_random(seed) % 2;
+            out[n++] = '/';
+            out[n++] = block ? '*' : '/';
+            for (int i = 0; i < length; i++) {
+                out[n++] = (next_random(seed) % 5 == 0) ? ' ' : ident_chars[next_random(seed) % 52];
+            }
+            if (block) {
+                out[n++] = '*';
+                out[n++] = '/';
+            } else {
+                out[n++] = '\n';
+            }
+            break;
+        }
+        default: {
+            const char* op = operators[next_random(seed) % COUNT_OF(operators)];
+            n = (int)strlen(op);
+            memcpy(out, op, (size_t)n);
+            break;
+        }
+    }
+    return n;
+}
+
+// 生成约size字节的文本
+char* corpus_generate(size_t size, const CorpusMix* mix, unsigned seed, size_t* length) {
+    unsigned total = 0;
+    for (int i = 0; i < PIECE_COUNT; i++) total += mix->weight[i];
+    if (total == 0) return NULL;
+
+    char* text = (char*)malloc(size + 128);
+    if (!text) return NULL;
+
+    size_t n = 0;
+    int column = 0;
+    while (n < size) {
+        n += (size_t)write_piece(text + n, pick_kind(mix, total, &seed), &seed);
+
+        // Token之间用空格分隔，大约每10个Token换一行并缩进
+        if (++column >= 10 && next_random(&seed) % 4 == 0) {
+            text[n++] = '\n';
+            text[n++] = ' ';
+            text[n++] = ' ';
+            text[n++] = ' ';
+            text[n++] = ' ';
+            column = 0;
+        } else {
+            text[n++] = ' ';
+        }
+    }
+    text[n] = '\0';
+    *length = n;
+    return text;
+}
@@ -0,0 +1,37 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stddef.h>
+
+// 基准测试用的合成源程序
+// 按给定比例随机生成各类Token（固定种子，同样的参数总是生成同样的文本）
+
+typedef enum {
+    PIECE_IDENT,        // 标识符
+    PIECE_KEYWORD,      // 关键字
+    PIECE_INT,          // 整数
+    PIECE_FLOAT,        // 小数
+    PIECE_STRING,       // 字符串
+    PIECE_COMMENT,      // 注释（单行和多行）
+    PIECE_OPERATOR,     // 运算符和分隔符
+    PIECE_COUNT
+} PieceKind;
+
+// 各类Token的权重
+typedef struct {
+    unsigned weight[PIECE_COUNT];
+} CorpusMix;
+
+// 默认比例（大致接近手写程序）
+void corpus_default_mix(CorpusMix* mix);
+
+// 解析 "ident=30,kw=15,int=10,float=5,str=5,comment=5,op=30" 形式的比例，未给出的类别权重为0
+int corpus_parse_mix(const char* spec, CorpusMix* mix);
+
+// 打印比例
+void corpus_print_mix(const CorpusMix* mix);
+
+// 生成约size字节的文本（以'\0'结尾，调用者free），失败返回NULL
+char* corpus_generate(size_t size, const CorpusMix* mix, unsigned seed, size_t* length);
+
+#endif
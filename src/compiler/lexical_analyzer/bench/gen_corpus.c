@@ -0,0 +1,28 @@
+// 生成基准测试用的源程序
+// 用法: gen_corpus [字节数] [种子] [比例] > corpus.txt
+// 比例例如 "ident=30,kw=15,int=10,float=5,str=5,comment=5,op=30"
+#include <stdio.h>
+#include <stdlib.h>
+#include "corpus.h"
+
+int main(int argc, char* argv[]) {
+    size_t size = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : (size_t)16 << 20;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 12345u;
+
+    CorpusMix mix;
+    corpus_default_mix(&mix);
+    if (argc > 3 && !corpus_parse_mix(argv[3], &mix)) {
+        fprintf(stderr, "错误：无法解析比例 %s\n", argv[3]);
+        return 1;
+    }
+
+    size_t length;
+    char* text = corpus_generate(size, &mix, seed, &length);
+    if (!text) {
+        fprintf(stderr, "错误：内存不足\n");
+        return 1;
+    }
+    fwrite(text, 1, length, stdout);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,850 @@
+// 词法分析器生成器
+// 用法: gen_lexer [tokens.spec] [输出目录]
+//
+// 读入词法规则（格式见tokens.spec开头的说明），生成三个头文件：
+//   token_types.h   TokenType枚举，以及另外两个文件内容的哈希（Token缓存用它发现表的改变）
+//   lexer_tables.h  字符类别表、最小化DFA的转移表、接受状态和Token显示名
+//   keyword_hash.h  关键字的完美哈希查找
+// 正则表达式先用Thompson构造转成NFA，子集构造转成DFA，再用Moore划分细化最小化，
+// 最后把转移完全相同的字节合成一个字符类别，压缩转移表的列数。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAX_RULES 128
+#define MAX_GROUPS 32
+#define MAX_NFA 2048
+#define MAX_DFA 255         // 状态编号存成unsigned char
+#define NFA_WORDS (MAX_NFA / 64)
+
+// ==================== 规则文件 ====================
+
+typedef enum {
+    RULE_REGEX,     // 由DFA识别
+    RULE_KEYWORD,   // 关键字
+    RULE_NONE       // 扫描器直接产生
+} RuleKind;
+
+typedef struct {
+    char name[32];          // 类型名，如TK_ID
+    char display[32];       // 显示名，如ID
+    RuleKind kind;
+    char pattern[256];      // 正则或关键字
+    char comment[128];
+    int line;               // 在规则文件中的行号
+} Rule;
+
+static Rule rules[MAX_RULES];
+static int rule_count = 0;
+
+// 分组标题（写在第before条规则之前）
+static struct {
+    int before;
+    char title[128];
+} groups[MAX_GROUPS];
+static int group_count = 0;
+
+static unsigned char skip_chars[256];       // %skip给出的空白字符
+
+static void fail(int line, const char* message, const char* detail) {
+    fprintf(stderr, "tokens.spec:%d: 错误：%s%s%s\n", line, message, detail ? " " : "", detail ? detail : "");
+    exit(1);
+}
+
+// 取一个以空白分隔的单词
+static const char* read_word(const char* p, char* out, size_t size, int line) {
+    while (*p == ' ' || *p == '\t') p++;
+    size_t n = 0;
+    while (*p && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+        if (n + 1 >= size) fail(line, "名字太长", NULL);
+        out[n++] = *p++;
+    }
+    out[n] = '\0';
+    return p;
+}
+
+// 取一个以open/close括起来的部分（反斜杠转义的字符原样保留）
+static const char* read_delimited(const char* p, char close, char* out, size_t size, int line) {
+    size_t n = 0;
+    p++;
+    while (*p && *p != close) {
+        if (*p == '\\' && p[1]) {
+            if (n + 2 >= size) fail(line, "规则太长", NULL);
+            out[n++] = *p++;
+        }
+        if (n + 1 >= size) fail(line, "规则太长", NULL);
+        out[n++] = *p++;
+    }
+    if (*p != close) fail(line, "规则没有结束", NULL);
+    out[n] = '\0';
+    return p + 1;
+}
+
+static void parse_set(const char* p, unsigned char* set, int line);
+
+static void read_spec(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "错误：无法打开 %s\n", filename);
+        exit(1);
+    }
+
+    char buffer[1024];
+    int line = 0;
+    while (fgets(buffer, sizeof(buffer), file)) {
+        line++;
+        const char* p = buffer;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        if (p[0] == '#' && p[1] == '#') {
+            if (group_count == MAX_GROUPS) fail(line, "分组太多", NULL);
+            p += 2;
+            while (*p == ' ') p++;
+            size_t n = strcspn(p, "\r\n");
+            if (n >= sizeof(groups[0].title)) n = sizeof(groups[0].title) - 1;
+            memcpy(groups[group_count].title, p, n);
+            groups[group_count].title[n] = '\0';
+            groups[group_count].before = rule_count;
+            group_count++;
+            continue;
+        }
+        if (*p == '#') continue;
+
+        if (strncmp(p, "%skip", 5) == 0) {
+            p += 5;
+            while (*p == ' ' || *p == '\t') p++;
+            if (*p != '[') fail(line, "%skip后面应该是字符集", NULL);
+            char set[256];
+            read_delimited(p, ']', set, sizeof(set), line);
+            parse_set(set, skip_chars, line);
+            continue;
+        }
+
+        if (rule_count == MAX_RULES) fail(line, "规则太多", NULL);
+        Rule* rule = &rules[rule_count];
+        rule->line = line;
+        p = read_word(p, rule->name, sizeof(rule->name), line);
+        p = read_word(p, rule->display, sizeof(rule->display), line);
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '/') {
+            rule->kind = RULE_REGEX;
+            p = read_delimited(p, '/', rule->pattern, sizeof(rule->pattern), line);
+        } else if (*p == '"') {
+            rule->kind = RULE_KEYWORD;
+            p = read_delimited(p, '"', rule->pattern, sizeof(rule->pattern), line);
+            if (!rule->pattern[0]) fail(line, "关键字不能为空", NULL);
+        } else if (*p == '-') {
+            rule->kind = RULE_NONE;
+            p++;
+        } else {
+            fail(line, "规则应该是 /正则/、\"关键字\" 或 -", NULL);
+        }
+        if (!rule->name[0] || !rule->display[0]) fail(line, "缺少类型名或显示名", NULL);
+
+        while (*p == ' ' || *p == '\t') p++;
+        if (p[0] == '/' && p[1] == '/') {
+            p += 2;
+            while (*p == ' ') p++;
+            size_t n = strcspn(p, "\r\n");
+            if (n >= sizeof(rule->comment)) n = sizeof(rule->comment) - 1;
+            memcpy(rule->comment, p, n);
+            rule->comment[n] = '\0';
+        } else if (*p != '\n' && *p != '\r' && *p != '\0') {
+            fail(line, "规则后面多余的内容:", p);
+        }
+        rule_count++;
+    }
+    fclose(file);
+}
+
+// 按名字找规则，找不到返回-1
+static int find_rule(const char* name) {
+    for (int i = 0; i < rule_count; i++) {
+        if (strcmp(rules[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// ==================== 正则 → NFA（Thompson构造） ====================
+
+// 每个NFA状态最多一条字符集转移，或者最多两条空转移
+typedef struct {
+    unsigned char on[256];  // 字符集转移的字节集合
+    int on_target;          // 字符集转移的目标，-1表示没有
+    int eps[2];
+    int eps_count;
+    int accept;             // 接受的规则下标，-1表示不是接受状态
+} NfaState;
+
+static NfaState nfa[MAX_NFA];
+static int nfa_count = 0;
+static int rule_start[MAX_RULES];   // 各正则规则的NFA起始状态
+
+typedef struct {
+    int start;
+    int end;                // 还没有出边的结束状态
+} Fragment;
+
+static const char* regex;   // 正在解析的正则
+static int regex_line;
+
+static int new_state() {
+    if (nfa_count == MAX_NFA) fail(regex_line, "NFA状态太多", NULL);
+    NfaState* s = &nfa[nfa_count];
+    memset(s->on, 0, sizeof(s->on));
+    s->on_target = -1;
+    s->eps_count = 0;
+    s->accept = -1;
+    return nfa_count++;
+}
+
+static void add_eps(int from, int to) {
+    nfa[from].eps[nfa[from].eps_count++] = to;
+}
+
+// 转义字符的含义
+static unsigned char escape_char(char c) {
+    switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'v': return '\v';
+        case 'f': return '\f';
+        case '0': return '\0';
+        default: return (unsigned char)c;
+    }
+}
+
+// 解析字符集 [...] 的内部（p指向'['之后的内容，以'\0'结尾）
+static void parse_set(const char* p, unsigned char* set, int line) {
+    int negate = 0;
+    unsigned char chosen[256] = { 0 };
+    if (*p == '^') {
+        negate = 1;
+        p++;
+    }
+    while (*p) {
+        unsigned char low = (unsigned char)*p++;
+        if (low == '\\') {
+            if (!*p) fail(line, "字符集以反斜杠结尾", NULL);
+            low = escape_char(*p++);
+        }
+        unsigned char high = low;
+        if (p[0] == '-' && p[1]) {
+            p++;
+            high = (unsigned char)*p++;
+            if (high == '\\') {
+                if (!*p) fail(line, "字符集以反斜杠结尾", NULL);
+                high = escape_char(*p++);
+            }
+            if (high < low) fail(line, "字符集的范围颠倒", NULL);
+        }
+        for (int c = low; c <= high; c++) chosen[c] = 1;
+    }
+    for (int c = 0; c < 256; c++) {
+        if (chosen[c] != negate) set[c] = 1;
+    }
+}
+
+static Fragment parse_alternation();
+
+// 一个字符集转移
+static Fragment byte_set(const unsigned char* set) {
+    Fragment f = { new_state(), new_state() };
+    memcpy(nfa[f.start].on, set, 256);
+    nfa[f.start].on_target = f.end;
+    return f;
+}
+
+// atom := '(' alternation ')' | '[' set ']' | '.' | '\' c | c
+static Fragment parse_atom() {
+    unsigned char set[256] = { 0 };
+    char c = *regex++;
+    if (c == '(') {
+        Fragment f = parse_alternation();
+        if (*regex != ')') fail(regex_line, "括号不匹配", NULL);
+        regex++;
+        return f;
+    }
+    if (c == '[') {
+        char inner[256];
+        size_t n = 0;
+        while (*regex && *regex != ']') {
+            if (*regex == '\\' && regex[1]) inner[n++] = *regex++;
+            if (n + 1 >= sizeof(inner)) fail(regex_line, "字符集太长", NULL);
+            inner[n++] = *regex++;
+        }
+        if (*regex != ']') fail(regex_line, "字符集没有结束", NULL);
+        regex++;
+        inner[n] = '\0';
+        parse_set(inner, set, regex_line);
+        return byte_set(set);
+    }
+    if (c == '.') {
+        memset(set, 1, sizeof(set));
+        return byte_set(set);
+    }
+    if (c == '\\') {
+        if (!*regex) fail(regex_line, "正则以反斜杠结尾", NULL);
+        c = (char)escape_char(*regex++);
+    }
+    set[(unsigned char)c] = 1;
+    return byte_set(set);
+}
+
+// repeat := atom ('*' | '+' | '?')*
+static Fragment parse_repeat() {
+    Fragment f = parse_atom();
+    while (*regex == '*' || *regex == '+' || *regex == '?') {
+        char op = *regex++;
+        Fragment g = { new_state(), new_state() };
+        add_eps(g.start, f.start);
+        if (op != '+') add_eps(g.start, g.end);     // 可以一次也不出现
+        if (op != '?') add_eps(f.end, f.start);     // 可以重复
+        add_eps(f.end, g.end);
+        f = g;
+    }
+    return f;
+}
+
+// concatenation := repeat*
+static Fragment parse_concatenation() {
+    Fragment f = { new_state(), -1 };
+    f.end = f.start;
+    while (*regex && *regex != '|' && *regex != ')') {
+        if (*regex == '*' || *regex == '+' || *regex == '?') fail(regex_line, "重复符号前面没有内容", NULL);
+        Fragment g = parse_repeat();
+        add_eps(f.end, g.start);
+        f.end = g.end;
+    }
+    return f;
+}
+
+// alternation := concatenation ('|' concatenation)*
+static Fragment parse_alternation() {
+    Fragment f = parse_concatenation();
+    while (*regex == '|') {
+        regex++;
+        Fragment g = parse_concatenation();
+        Fragment h = { new_state(), new_state() };
+        add_eps(h.start, f.start);
+        add_eps(h.start, g.start);
+        add_eps(f.end, h.end);
+        add_eps(g.end, h.end);
+        f = h;
+    }
+    return f;
+}
+
+static void build_nfa() {
+    for (int i = 0; i < rule_count; i++) {
+        rule_start[i] = -1;
+        if (rules[i].kind != RULE_REGEX) continue;
+        regex = rules[i].pattern;
+        regex_line = rules[i].line;
+        Fragment f = parse_alternation();
+        if (*regex) fail(regex_line, "括号不匹配", NULL);
+        nfa[f.end].accept = i;
+        rule_start[i] = f.start;
+    }
+}
+
+// ==================== NFA → DFA（子集构造） ====================
+
+typedef struct {
+    uint64_t bits[NFA_WORDS];
+} NfaSet;
+
+static NfaSet dfa_sets[MAX_DFA + 1];
+static int dfa_next[MAX_DFA + 1][256];
+static int dfa_accept[MAX_DFA + 1];
+static int dfa_count = 0;
+
+static int set_has(const NfaSet* set, int state) {
+    return (int)((set->bits[state / 64] >> (state % 64)) & 1);
+}
+
+static void set_add(NfaSet* set, int state) {
+    set->bits[state / 64] |= (uint64_t)1 << (state % 64);
+}
+
+// 空转移闭包
+static void closure(NfaSet* set) {
+    int stack[MAX_NFA];
+    int top = 0;
+    for (int i = 0; i < nfa_count; i++) {
+        if (set_has(set, i)) stack[top++] = i;
+    }
+    while (top > 0) {
+        int state = stack[--top];
+        for (int j = 0; j < nfa[state].eps_count; j++) {
+            int next = nfa[state].eps[j];
+            if (!set_has(set, next)) {
+                set_add(set, next);
+                stack[top++] = next;
+            }
+        }
+    }
+}
+
+// 查找或新建NFA状态集合对应的DFA状态
+static int dfa_state(const NfaSet* set) {
+    for (int i = 0; i < dfa_count; i++) {
+        if (memcmp(&dfa_sets[i], set, sizeof(NfaSet)) == 0) return i;
+    }
+    if (dfa_count == MAX_DFA) fail(0, "DFA状态太多", NULL);
+    dfa_sets[dfa_count] = *set;
+
+    // 同时接受几条规则时取写在前面的
+    int accept = -1;
+    for (int i = 0; i < nfa_count; i++) {
+        if (set_has(set, i) && nfa[i].accept >= 0 && (accept < 0 || nfa[i].accept < accept)) {
+            accept = nfa[i].accept;
+        }
+    }
+    dfa_accept[dfa_count] = accept;
+    return dfa_count++;
+}
+
+// DFA状态0是空集（没有转移），1是起始状态
+static void build_dfa() {
+    NfaSet set;
+    memset(&set, 0, sizeof(set));
+    dfa_state(&set);
+    for (int i = 0; i < rule_count; i++) {
+        if (rule_start[i] >= 0) set_add(&set, rule_start[i]);
+    }
+    closure(&set);
+    dfa_state(&set);
+
+    for (int d = 0; d < dfa_count; d++) {
+        for (int c = 0; c < 256; c++) {
+            NfaSet next;
+            memset(&next, 0, sizeof(next));
+            for (int i = 0; i < nfa_count; i++) {
+                if (set_has(&dfa_sets[d], i) && nfa[i].on_target >= 0 && nfa[i].on[c]) {
+                    set_add(&next, nfa[i].on_target);
+                }
+            }
+            closure(&next);
+            dfa_next[d][c] = dfa_state(&next);
+        }
+    }
+}
+
+// ==================== DFA最小化（Moore划分细化） ====================
+
+static int group_of[MAX_DFA + 1];   // DFA状态所在的组（即最小化后的状态）
+static int min_count = 0;
+
+static void minimize() {
+    // 先按接受的规则分组，然后反复按"本组 + 每个字节转移到的组"细分，直到组数不再增加
+    int signature_count = 0;
+    for (int d = 0; d < dfa_count; d++) {
+        int g = -1;
+        for (int e = 0; e < d; e++) {
+            if (dfa_accept[e] == dfa_accept[d]) {
+                g = group_of[e];
+                break;
+            }
+        }
+        group_of[d] = g >= 0 ? g : signature_count++;
+    }
+
+    while (1) {
+        int next_group[MAX_DFA + 1];
+        int count = 0;
+        for (int d = 0; d < dfa_count; d++) {
+            next_group[d] = -1;
+            for (int e = 0; e < d && next_group[d] < 0; e++) {
+                if (group_of[e] != group_of[d]) continue;
+                int same = 1;
+                for (int c = 0; c < 256 && same; c++) {
+                    if (group_of[dfa_next[e][c]] != group_of[dfa_next[d][c]]) same = 0;
+                }
+                if (same) next_group[d] = next_group[e];
+            }
+            if (next_group[d] < 0) next_group[d] = count++;
+        }
+        memcpy(group_of, next_group, sizeof(int) * (size_t)dfa_count);
+        if (count == signature_count) break;
+        signature_count = count;
+    }
+    min_count = signature_count;
+}
+
+// ==================== 编号、字符类别和检查 ====================
+
+static int state_id[MAX_DFA + 1];       // 组 → 输出的状态编号（0为停止，1为起始）
+static int out_next[MAX_DFA + 1][256];  // 按输出编号的转移
+static int out_accept[MAX_DFA + 1];
+static int out_pending[MAX_DFA + 1];
+static int byte_class[256];
+static int class_byte[256];             // 每个类别的一个代表字节
+static int class_count = 0;
+static int ident_state = -1;
+
+static void number_states() {
+    int representative[MAX_DFA + 1];
+    for (int g = 0; g < min_count; g++) {
+        state_id[g] = -1;
+        representative[g] = -1;
+    }
+    for (int d = dfa_count - 1; d >= 0; d--) representative[group_of[d]] = d;
+
+    // 停止状态为0，起始状态为1，其余按从起始状态出发的广度优先顺序编号
+    int order[MAX_DFA + 1];
+    int count = 0;
+    state_id[group_of[0]] = count;
+    order[count++] = group_of[0];
+    if (state_id[group_of[1]] < 0) {
+        state_id[group_of[1]] = count;
+        order[count++] = group_of[1];
+    }
+    for (int i = 1; i < count; i++) {
+        int d = representative[order[i]];
+        for (int c = 0; c < 256; c++) {
+            int g = group_of[dfa_next[d][c]];
+            if (state_id[g] < 0) {
+                state_id[g] = count;
+                order[count++] = g;
+            }
+        }
+    }
+    min_count = count;
+
+    for (int i = 0; i < count; i++) {
+        int d = representative[order[i]];
+        out_accept[i] = dfa_accept[d];
+        for (int c = 0; c < 256; c++) out_next[i][c] = state_id[group_of[dfa_next[d][c]]];
+    }
+}
+
+// 转移完全相同的字节合成一个类别（字节0所在的类别编号为0）
+static void compute_classes() {
+    for (int c = 0; c < 256; c++) {
+        byte_class[c] = -1;
+        for (int k = 0; k < class_count; k++) {
+            int same = 1;
+            for (int s = 0; s < min_count && same; s++) {
+                if (out_next[s][class_byte[k]] != out_next[s][c]) same = 0;
+            }
+            if (same) {
+                byte_class[c] = k;
+                break;
+            }
+        }
+        if (byte_class[c] < 0) {
+            class_byte[class_count] = c;
+            byte_class[c] = class_count++;
+        }
+    }
+}
+
+// 检查扫描器的约定，并算出未完成状态可能识别的Token类型
+static void check_states() {
+    int id_rule = find_rule("TK_ID");
+    if (id_rule < 0 || rules[id_rule].kind != RULE_REGEX) fail(0, "缺少TK_ID的正则规则", NULL);
+    if (find_rule("TK_EOF") < 0 || find_rule("TK_ERROR") < 0) fail(0, "缺少TK_EOF或TK_ERROR", NULL);
+
+    for (int s = 1; s < min_count; s++) {
+        if (out_accept[s] == id_rule) {
+            if (ident_state >= 0) fail(rules[id_rule].line, "TK_ID对应多个DFA状态，扫描器要求只有一个", NULL);
+            ident_state = s;
+        }
+
+        // 不能回退：接受状态之后不能进入非接受状态
+        for (int c = 0; c < 256; c++) {
+            int t = out_next[s][c];
+            if (out_accept[s] >= 0 && t != 0 && out_accept[t] < 0) {
+                fail(rules[out_accept[s]].line, "规则需要回退，扫描器不支持:", rules[out_accept[s]].name);
+            }
+        }
+        if (id_rule >= 0 && out_accept[s] == id_rule) {
+            for (int c = 0x80; c < 256; c++) {
+                if (out_next[s][c] != 0) fail(rules[id_rule].line, "TK_ID只能接受ASCII字符", NULL);
+            }
+        }
+    }
+    for (int c = 0x80; c < 256; c++) {
+        if (out_next[1][c] == ident_state) fail(rules[id_rule].line, "TK_ID只能接受ASCII字符", NULL);
+    }
+
+    // 未完成状态：从它出发能到达的接受状态只属于一条规则时记下这条规则
+    for (int s = 0; s < min_count; s++) {
+        out_pending[s] = -1;
+        if (s <= 1 || out_accept[s] >= 0) continue;
+        int seen[MAX_DFA + 1] = { 0 };
+        int stack[MAX_DFA + 1];
+        int top = 0, pending = -1, unique = 1;
+        stack[top++] = s;
+        seen[s] = 1;
+        while (top > 0) {
+            int u = stack[--top];
+            if (out_accept[u] >= 0) {
+                if (pending >= 0 && pending != out_accept[u]) unique = 0;
+                pending = out_accept[u];
+            }
+            for (int c = 0; c < 256; c++) {
+                int t = out_next[u][c];
+                if (t != 0 && !seen[t]) {
+                    seen[t] = 1;
+                    stack[top++] = t;
+                }
+            }
+        }
+        if (unique) out_pending[s] = pending;
+    }
+}
+
+// ==================== 输出 ====================
+
+static FILE* open_output(const char* dir, const char* name) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "错误：无法写入 %s\n", path);
+        exit(1);
+    }
+    return out;
+}
+
+static const char* type_name(int rule) {
+    return rule >= 0 ? rules[rule].name : "0";
+}
+
+// FNV-1a，接着hash继续混入
+static uint32_t hash_bytes(uint32_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 混入已经写出的文件的内容
+static uint32_t hash_output(uint32_t hash, const char* dir, const char* name) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        fprintf(stderr, "错误：无法读取 %s\n", path);
+        exit(1);
+    }
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0) hash = hash_bytes(hash, buffer, got);
+    fclose(in);
+    return hash;
+}
+
+// 生成的扫描器的哈希：Token类型的编号、DFA表和关键字表，任何一项改变扫描器的输出都可能不同
+static uint32_t scanner_hash(const char* dir) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < rule_count; i++) hash = hash_bytes(hash, rules[i].name, strlen(rules[i].name) + 1);
+    hash = hash_output(hash, dir, "lexer_tables.h");
+    return hash_output(hash, dir, "keyword_hash.h");
+}
+
+// 在lexer_tables.h和keyword_hash.h之后写出，其中的LEXER_TABLES_HASH由它们的内容算出
+static void write_token_types(const char* dir) {
+    uint32_t hash = scanner_hash(dir);
+    FILE* out = open_output(dir, "token_types.h");
+    fprintf(out, "// 由 gen_lexer.c 根据 tokens.spec 生成，请勿手工修改\n");
+    fprintf(out, "#ifndef TOKEN_TYPES_H\n");
+    fprintf(out, "#define TOKEN_TYPES_H\n\n");
+    fprintf(out, "// Token类型枚举\n");
+    fprintf(out, "typedef enum {\n");
+    int group = 0;
+    for (int i = 0; i < rule_count; i++) {
+        for (; group < group_count && groups[group].before == i; group++) {
+            if (i > 0) fprintf(out, "    \n");
+            fprintf(out, "    // %s\n", groups[group].title);
+        }
+        char item[64];
+        snprintf(item, sizeof(item), "%s%s%s", rules[i].name, i == 0 ? " = 1" : "", i + 1 < rule_count ? "," : "");
+        if (rules[i].comment[0]) fprintf(out, "    %-16s// %s\n", item, rules[i].comment);
+        else fprintf(out, "    %s\n", item);
+    }
+    fprintf(out, "} TokenType;\n\n");
+    fprintf(out, "#define TOKEN_TYPE_COUNT %d   // 最大的类型编号加1\n\n", rule_count + 1);
+    fprintf(out, "// 生成的Token类型、DFA表和关键字表的哈希（Token缓存用它判断扫描器是否重新生成过）\n");
+    fprintf(out, "#define LEXER_TABLES_HASH 0x%08Xu\n\n", hash);
+    fprintf(out, "#endif\n");
+    fclose(out);
+}
+
+static void write_lexer_tables(const char* dir) {
+    FILE* out = open_output(dir, "lexer_tables.h");
+    fprintf(out, "// 由 gen_lexer.c 根据 tokens.spec 生成，请勿手工修改\n");
+    fprintf(out, "// NFA %d 个状态 → DFA %d 个状态 → 最小化后 %d 个状态，%d 个字符类别\n",
+            nfa_count, dfa_count, min_count, class_count);
+    fprintf(out, "#ifndef LEXER_TABLES_H\n");
+    fprintf(out, "#define LEXER_TABLES_H\n\n");
+    fprintf(out, "#define LEXER_STOP 0        // 没有转移，Token在此结束\n");
+    fprintf(out, "#define LEXER_START 1\n");
+    fprintf(out, "#define LEXER_IDENT %d       // 接受TK_ID的状态\n", ident_state);
+    fprintf(out, "#define LEXER_STATES %d\n", min_count);
+    fprintf(out, "#define LEXER_CLASSES %d\n\n", class_count);
+
+    fprintf(out, "// 字节 → 字符类别（转移完全相同的字节是同一类）\n");
+    fprintf(out, "static const unsigned char lexer_class[256] = {\n");
+    for (int c = 0; c < 256; c += 16) {
+        fprintf(out, "   ");
+        for (int k = c; k < c + 16; k++) fprintf(out, " %2d,", byte_class[k]);
+        fprintf(out, "\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// 状态转移表：lexer_next[状态][字符类别]\n");
+    fprintf(out, "static const unsigned char lexer_next[LEXER_STATES][LEXER_CLASSES] = {\n");
+    for (int s = 0; s < min_count; s++) {
+        fprintf(out, "    {");
+        for (int k = 0; k < class_count; k++) fprintf(out, "%s%d", k ? ", " : "", out_next[s][class_byte[k]]);
+        fprintf(out, "},");
+        if (s == 0) fprintf(out, "   // 停止");
+        else if (s == 1) fprintf(out, "   // 起始");
+        else if (out_accept[s] >= 0) fprintf(out, "   // %s", rules[out_accept[s]].name);
+        else if (out_pending[s] >= 0) fprintf(out, "   // %s（未完成）", rules[out_pending[s]].name);
+        fprintf(out, "\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// 接受状态对应的Token类型，0表示不是接受状态\n");
+    fprintf(out, "static const TokenType lexer_accept[LEXER_STATES] = {\n");
+    for (int s = 0; s < min_count; s++) fprintf(out, "    %s,\n", type_name(out_accept[s]));
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// 未完成状态只可能是某一种Token的前缀时的类型（用于报告错误），否则为0\n");
+    fprintf(out, "static const TokenType lexer_pending[LEXER_STATES] = {\n");
+    for (int s = 0; s < min_count; s++) fprintf(out, "    %s,\n", type_name(out_pending[s]));
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// 不能开始任何Token、也不是空白的ASCII字符\n");
+    fprintf(out, "static const unsigned char lexer_stray[128] = {\n");
+    for (int c = 0; c < 128; c += 16) {
+        fprintf(out, "   ");
+        for (int k = c; k < c + 16; k++) fprintf(out, " %d,", out_next[1][k] == 0 && !skip_chars[k]);
+        fprintf(out, "\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// Token类型的显示名\n");
+    fprintf(out, "static const char* const lexer_token_names[TOKEN_TYPE_COUNT] = {\n");
+    for (int i = 0; i < rule_count; i++) {
+        fprintf(out, "    [%s] = \"%s\",\n", rules[i].name, rules[i].display);
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "#endif\n");
+    fclose(out);
+}
+
+// 关键字完美哈希：以 (长度, 首字符, 末字符) 为键搜索无冲突的乘数，
+// 查找只需一次哈希、一次长度比较和一次memcmp确认
+#define TABLE_BITS 5
+#define TABLE_SIZE (1 << TABLE_BITS)
+
+static unsigned keyword_hash(const char* word, size_t length, unsigned a, unsigned b) {
+    unsigned first = (unsigned char)word[0];
+    unsigned last = (unsigned char)word[length - 1];
+    return (first * a + last * b + (unsigned)length) & (TABLE_SIZE - 1);
+}
+
+static void write_keyword_hash(const char* dir) {
+    int slot[TABLE_SIZE];
+    size_t min_len = 255, max_len = 0;
+    int keyword_count = 0;
+    for (int i = 0; i < rule_count; i++) {
+        if (rules[i].kind != RULE_KEYWORD) continue;
+        size_t length = strlen(rules[i].pattern);
+        if (length < min_len) min_len = length;
+        if (length > max_len) max_len = length;
+        keyword_count++;
+    }
+    if (keyword_count == 0) min_len = 1;
+
+    for (unsigned a = 1; a < 256; a++) {
+        for (unsigned b = 0; b < 256; b++) {
+            int ok = 1;
+            for (int i = 0; i < TABLE_SIZE; i++) slot[i] = -1;
+            for (int i = 0; i < rule_count && ok; i++) {
+                if (rules[i].kind != RULE_KEYWORD) continue;
+                unsigned h = keyword_hash(rules[i].pattern, strlen(rules[i].pattern), a, b);
+                if (slot[h] != -1) ok = 0;
+                slot[h] = i;
+            }
+            if (!ok) continue;
+
+            FILE* out = open_output(dir, "keyword_hash.h");
+            fprintf(out, "// 由 gen_lexer.c 根据 tokens.spec 生成，请勿手工修改\n");
+            fprintf(out, "#ifndef KEYWORD_HASH_H\n");
+            fprintf(out, "#define KEYWORD_HASH_H\n\n");
+            fprintf(out, "#include <stddef.h>\n");
+            fprintf(out, "#include <string.h>\n\n");
+            fprintf(out, "#define KEYWORD_MIN_LEN %zu\n", min_len);
+            fprintf(out, "#define KEYWORD_MAX_LEN %zu\n\n", max_len);
+            fprintf(out, "// 完美哈希表（空槽位长度为0）\n");
+            fprintf(out, "static const struct {\n");
+            fprintf(out, "    const char* word;\n");
+            fprintf(out, "    unsigned char length;\n");
+            fprintf(out, "    TokenType type;\n");
+            fprintf(out, "} keyword_table[%d] = {\n", TABLE_SIZE);
+            for (int i = 0; i < TABLE_SIZE; i++) {
+                if (slot[i] == -1) {
+                    fprintf(out, "    {\"\", 0, TK_ID},\n");
+                } else {
+                    fprintf(out, "    {\"%s\", %zu, %s},\n", rules[slot[i]].pattern,
+                            strlen(rules[slot[i]].pattern), rules[slot[i]].name);
+                }
+            }
+            fprintf(out, "};\n\n");
+            fprintf(out, "// 查找关键字，不是关键字时返回TK_ID\n");
+            fprintf(out, "static inline TokenType keyword_lookup(const char* word, size_t length) {\n");
+            fprintf(out, "    if (length < KEYWORD_MIN_LEN || length > KEYWORD_MAX_LEN) return TK_ID;\n");
+            fprintf(out, "    unsigned h = ((unsigned char)word[0] * %uu + "
+                    "(unsigned char)word[length - 1] * %uu + (unsigned)length) & %d;\n",
+                    a, b, TABLE_SIZE - 1);
+            fprintf(out, "    if (keyword_table[h].length == length &&\n");
+            fprintf(out, "        memcmp(keyword_table[h].word, word, length) == 0) {\n");
+            fprintf(out, "        return keyword_table[h].type;\n");
+            fprintf(out, "    }\n");
+            fprintf(out, "    return TK_ID;\n");
+            fprintf(out, "}\n\n");
+            fprintf(out, "#endif\n");
+            fclose(out);
+            return;
+        }
+    }
+
+    fprintf(stderr, "错误：找不到无冲突的关键字哈希函数，请增大TABLE_BITS\n");
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    const char* spec = argc > 1 ? argv[1] : "tokens.spec";
+    const char* dir = argc > 2 ? argv[2] : ".";
+
+    read_spec(spec);
+    for (int i = 0; i < rule_count; i++) {
+        if (find_rule(rules[i].name) != i) fail(rules[i].line, "类型名重复:", rules[i].name);
+    }
+
+    build_nfa();
+    build_dfa();
+    minimize();
+    number_states();
+    compute_classes();
+    check_states();
+    if (min_count > MAX_DFA) fail(0, "DFA状态太多", NULL);
+
+    write_lexer_tables(dir);
+    write_keyword_hash(dir);
+    write_token_types(dir);
+    fprintf(stderr, "%d 条规则：NFA %d 个状态 → DFA %d 个状态 → 最小化后 %d 个状态，%d 个字符类别\n",
+            rule_count, nfa_count, dfa_count, min_count, class_count);
+    return 0;
+}
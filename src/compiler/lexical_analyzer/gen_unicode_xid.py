@@ -0,0 +1,48 @@
+# 标识符字符属性表生成器
+# 用法: python gen_unicode_xid.py > unicode_xid.h
+#
+# 用Python自带的Unicode数据库计算XID_Start和XID_Continue（str.isidentifier()正是按这两个属性判断的），
+# 只生成非ASCII部分（ASCII字符由扫描器的DFA直接处理），相邻的码点合并成区间。
+import sys
+import unicodedata
+
+
+def ranges(predicate):
+    result = []
+    for c in range(0x80, sys.maxunicode + 1):
+        if not predicate(chr(c)):
+            continue
+        if result and result[-1][1] == c - 1:
+            result[-1][1] = c
+        else:
+            result.append([c, c])
+    return result
+
+
+def emit(name, table):
+    print("static const UnicodeRange %s[%d] = {" % (name, len(table)))
+    for i in range(0, len(table), 4):
+        row = ", ".join("{0x%05X, 0x%05X}" % (lo, hi) for lo, hi in table[i:i + 4])
+        print("    %s," % row)
+    print("};")
+    print()
+
+
+xid_start = ranges(lambda ch: ch.isidentifier())
+xid_continue = ranges(lambda ch: ("a" + ch).isidentifier())
+
+print("// 由 gen_unicode_xid.py 生成（Unicode %s），请勿手工修改" % unicodedata.unidata_version)
+print("#ifndef UNICODE_XID_H")
+print("#define UNICODE_XID_H")
+print()
+print("#include <stdint.h>")
+print()
+print("// 码点区间 [first, last]，按first递增排列")
+print("typedef struct {")
+print("    uint32_t first;")
+print("    uint32_t last;")
+print("} UnicodeRange;")
+print()
+emit("xid_start_ranges", xid_start)
+emit("xid_continue_ranges", xid_continue)
+print("#endif")
@@ -0,0 +1,189 @@
+#include "intern.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define SHARD_BITS 4
+#define SHARD_COUNT (1 << SHARD_BITS)       // 按哈希最高几位分片，每片一把锁
+#define PAGE_BITS 12
+#define PAGE_SIZE (1 << PAGE_BITS)          // 编号表按页分配，已发布的条目不会移动
+#define MAX_PAGES (1 << 14)
+#define BLOCK_SIZE (64 * 1024)              // 字符串存储块大小
+
+// 编号对应的条目
+typedef struct {
+    const char* text;
+    uint32_t length;
+    uint32_t hash;
+} InternEntry;
+
+// 分片哈希表的槽位（id为0表示空槽）
+typedef struct {
+    uint32_t hash;
+    uint32_t id;
+} InternSlot;
+
+// 一个分片：开放定址哈希表和字符串存储块
+typedef struct {
+    pthread_mutex_t lock;
+    InternSlot* slots;
+    uint32_t capacity;
+    uint32_t count;
+    char* block;
+    size_t block_used;
+    size_t block_size;
+} InternShard;
+
+#define SHARD_INIT { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, NULL, 0, 0 }
+
+static InternShard shards[SHARD_COUNT] = {
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT
+};
+
+static _Atomic(InternEntry*) pages[MAX_PAGES];
+static pthread_mutex_t page_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint next_id = 1;
+
+// FNV-1a
+uint32_t intern_hash_bytes(const char* text, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 编号对应的条目位置（所在页不存在时分配）
+static InternEntry* entry_slot(uint32_t id) {
+    uint32_t page = id >> PAGE_BITS;
+    if (page >= MAX_PAGES) return NULL;
+    
+    InternEntry* entries = atomic_load_explicit(&pages[page], memory_order_acquire);
+    if (!entries) {
+        pthread_mutex_lock(&page_lock);
+        entries = atomic_load_explicit(&pages[page], memory_order_relaxed);
+        if (!entries) {
+            entries = (InternEntry*)calloc(PAGE_SIZE, sizeof(InternEntry));
+            atomic_store_explicit(&pages[page], entries, memory_order_release);
+        }
+        pthread_mutex_unlock(&page_lock);
+        if (!entries) return NULL;
+    }
+    return &entries[id & (PAGE_SIZE - 1)];
+}
+
+// 已发布的编号对应的条目
+static const InternEntry* entry_of(uint32_t id) {
+    InternEntry* entries = atomic_load_explicit(&pages[id >> PAGE_BITS], memory_order_acquire);
+    return &entries[id & (PAGE_SIZE - 1)];
+}
+
+// 扩大分片的哈希表（持有分片锁时调用）
+static int grow_shard(InternShard* shard) {
+    uint32_t capacity = shard->capacity ? shard->capacity * 2 : 256;
+    InternSlot* slots = (InternSlot*)calloc(capacity, sizeof(InternSlot));
+    if (!slots) return 0;
+    
+    for (uint32_t i = 0; i < shard->capacity; i++) {
+        if (shard->slots[i].id == INTERN_NONE) continue;
+        uint32_t j = shard->slots[i].hash & (capacity - 1);
+        while (slots[j].id != INTERN_NONE) j = (j + 1) & (capacity - 1);
+        slots[j] = shard->slots[i];
+    }
+    free(shard->slots);
+    shard->slots = slots;
+    shard->capacity = capacity;
+    return 1;
+}
+
+// 在分片的存储块中复制字符串（持有分片锁时调用）
+static const char* store_text(InternShard* shard, const char* text, size_t length) {
+    if (shard->block_used + length + 1 > shard->block_size) {
+        // 旧块剩余空间放弃，已复制的字符串仍然有效
+        size_t size = length + 1 > BLOCK_SIZE ? length + 1 : BLOCK_SIZE;
+        char* block = (char*)malloc(size);
+        if (!block) return NULL;
+        shard->block = block;
+        shard->block_used = 0;
+        shard->block_size = size;
+    }
+    
+    char* copy = shard->block + shard->block_used;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    shard->block_used += length + 1;
+    return copy;
+}
+
+// 取字符串的编号
+uint32_t intern(const char* text, size_t length) {
+    uint32_t hash = intern_hash_bytes(text, length);
+    InternShard* shard = &shards[hash >> (32 - SHARD_BITS)];
+    uint32_t id = INTERN_NONE;
+    
+    pthread_mutex_lock(&shard->lock);
+    
+    // 装载因子保持在1/2以下
+    if ((shard->count + 1) * 2 > shard->capacity && !grow_shard(shard)) {
+        pthread_mutex_unlock(&shard->lock);
+        return INTERN_NONE;
+    }
+    
+    uint32_t mask = shard->capacity - 1;
+    uint32_t i = hash & mask;
+    while (shard->slots[i].id != INTERN_NONE) {
+        if (shard->slots[i].hash == hash) {
+            const InternEntry* entry = entry_of(shard->slots[i].id);
+            if (entry->length == length && memcmp(entry->text, text, length) == 0) {
+                id = shard->slots[i].id;
+                pthread_mutex_unlock(&shard->lock);
+                return id;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+    
+    // 新字符串：先写好条目，再放进哈希表
+    const char* copy = store_text(shard, text, length);
+    if (copy) {
+        uint32_t new_id = atomic_fetch_add_explicit(&next_id, 1, memory_order_relaxed);
+        InternEntry* entry = entry_slot(new_id);
+        if (entry) {
+            entry->text = copy;
+            entry->length = (uint32_t)length;
+            entry->hash = hash;
+            shard->slots[i].hash = hash;
+            shard->slots[i].id = new_id;
+            shard->count++;
+            id = new_id;
+        }
+    }
+    
+    pthread_mutex_unlock(&shard->lock);
+    return id;
+}
+
+// 编号对应的文本
+const char* intern_text(uint32_t id) {
+    return entry_of(id)->text;
+}
+
+// 编号对应的文本长度
+uint32_t intern_length(uint32_t id) {
+    return entry_of(id)->length;
+}
+
+// 编号对应的哈希值
+uint32_t intern_hash(uint32_t id) {
+    return entry_of(id)->hash;
+}
+
+// 已分配的编号数量
+uint32_t intern_count() {
+    return atomic_load_explicit(&next_id, memory_order_relaxed) - 1;
+}
@@ -0,0 +1,27 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 标识符和字符串驻留池（整个进程共用一个）
+// 每个不同的字符串对应一个从1开始连续分配的32位编号，同一字符串总是得到同一编号，
+// 之后比较名字只需比较编号。插入按哈希分片加锁，多个线程可以同时分析不同文件。
+
+#define INTERN_NONE 0   // 无效编号（不是标识符或字符串的Token，value不是驻留编号）
+
+// 取字符串的编号，第一次出现时复制一份并分配新编号（内存不足时返回INTERN_NONE）
+uint32_t intern(const char* text, size_t length);
+
+// 按编号取回信息（编号必须由intern返回）
+const char* intern_text(uint32_t id);      // 以'\0'结尾，一直有效
+uint32_t intern_length(uint32_t id);
+uint32_t intern_hash(uint32_t id);         // 插入时算好的哈希值
+
+// 已分配的编号数量
+uint32_t intern_count();
+
+// 驻留池使用的哈希函数（FNV-1a）
+uint32_t intern_hash_bytes(const char* text, size_t length);
+
+#endif
@@ -0,0 +1,62 @@
+// 由 gen_lexer.c 根据 tokens.spec 生成，请勿手工修改
+#ifndef KEYWORD_HASH_H
+#define KEYWORD_HASH_H
+
+#include <stddef.h>
+#include <string.h>
+
+#define KEYWORD_MIN_LEN 2
+#define KEYWORD_MAX_LEN 7
+
+// 完美哈希表（空槽位长度为0）
+static const struct {
+    const char* word;
+    unsigned char length;
+    TokenType type;
+} keyword_table[32] = {
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"end", 3, TK_END},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"for", 3, TK_FOR},
+    {"", 0, TK_ID},
+    {"begin", 5, TK_BEGIN},
+    {"case", 4, TK_CASE},
+    {"", 0, TK_ID},
+    {"else", 4, TK_ELSE},
+    {"", 0, TK_ID},
+    {"false", 5, TK_FALSE},
+    {"do", 2, TK_DO},
+    {"", 0, TK_ID},
+    {"switch", 6, TK_SWITCH},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"if", 2, TK_IF},
+    {"", 0, TK_ID},
+    {"default", 7, TK_DEFAULT},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"then", 4, TK_THEN},
+    {"true", 4, TK_TRUE},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"", 0, TK_ID},
+    {"while", 5, TK_WHILE},
+};
+
+// 查找关键字，不是关键字时返回TK_ID
+static inline TokenType keyword_lookup(const char* word, size_t length) {
+    if (length < KEYWORD_MIN_LEN || length > KEYWORD_MAX_LEN) return TK_ID;
+    unsigned h = ((unsigned char)word[0] * 1u + (unsigned char)word[length - 1] * 7u + (unsigned)length) & 31;
+    if (keyword_table[h].length == length &&
+        memcmp(keyword_table[h].word, word, length) == 0) {
+        return keyword_table[h].type;
+    }
+    return TK_ID;
+}
+
+#endif
@@ -0,0 +1,177 @@
+// 由 gen_lexer.c 根据 tokens.spec 生成，请勿手工修改
+// NFA 107 个状态 → DFA 32 个状态 → 最小化后 27 个状态，21 个字符类别
+#ifndef LEXER_TABLES_H
+#define LEXER_TABLES_H
+
+#define LEXER_STOP 0        // 没有转移，Token在此结束
+#define LEXER_START 1
+#define LEXER_IDENT 17       // 接受TK_ID的状态
+#define LEXER_STATES 27
+#define LEXER_CLASSES 21
+
+// 字节 → 字符类别（转移完全相同的字节是同一类）
+static const unsigned char lexer_class[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  1,  2,  0,  0,  0,  0,  0,  3,  4,  5,  6,  7,  8,  9, 10,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 12, 13, 14, 15, 16,  0,
+     0, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+    17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,  0, 18,  0,  0, 17,
+     0, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+    17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 19,  0, 20,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+// 状态转移表：lexer_next[状态][字符类别]
+static const unsigned char lexer_next[LEXER_STATES][LEXER_CLASSES] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // 停止
+    {0, 2, 3, 4, 5, 6, 7, 8, 9, 0, 10, 11, 12, 13, 14, 15, 16, 17, 0, 18, 19},   // 起始
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0},   // TK_NE（未完成）
+    {3, 3, 21, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 22, 3, 3},   // TK_STR（未完成）
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_LPAREN
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_RPAREN
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_MUL
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_PLUS
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_COMMA
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_MINUS
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_DIV
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 0, 11, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_NUM
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_COLON
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_SEMICOLON
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 24, 20, 0, 0, 0, 0},   // TK_LT
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 0, 0, 0, 0, 0},   // TK_ASSIGN
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 26, 0, 0, 0, 0, 0},   // TK_GT
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0, 0, 17, 0, 0, 0},   // TK_ID
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_LBRACE
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_RBRACE
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_NE
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_STR
+    {3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3},   // TK_STR（未完成）
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_NUM
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_LE
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_EQ
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},   // TK_GE
+};
+
+// 接受状态对应的Token类型，0表示不是接受状态
+static const TokenType lexer_accept[LEXER_STATES] = {
+    0,
+    0,
+    0,
+    0,
+    TK_LPAREN,
+    TK_RPAREN,
+    TK_MUL,
+    TK_PLUS,
+    TK_COMMA,
+    TK_MINUS,
+    TK_DIV,
+    TK_NUM,
+    TK_COLON,
+    TK_SEMICOLON,
+    TK_LT,
+    TK_ASSIGN,
+    TK_GT,
+    TK_ID,
+    TK_LBRACE,
+    TK_RBRACE,
+    TK_NE,
+    TK_STR,
+    0,
+    TK_NUM,
+    TK_LE,
+    TK_EQ,
+    TK_GE,
+};
+
+// 未完成状态只可能是某一种Token的前缀时的类型（用于报告错误），否则为0
+static const TokenType lexer_pending[LEXER_STATES] = {
+    0,
+    0,
+    TK_NE,
+    TK_STR,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    0,
+    TK_STR,
+    0,
+    0,
+    0,
+    0,
+};
+
+// 不能开始任何Token、也不是空白的ASCII字符
+static const unsigned char lexer_stray[128] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1,
+};
+
+// Token类型的显示名
+static const char* const lexer_token_names[TOKEN_TYPE_COUNT] = {
+    [TK_BEGIN] = "BEGIN",
+    [TK_END] = "END",
+    [TK_IF] = "IF",
+    [TK_THEN] = "THEN",
+    [TK_ELSE] = "ELSE",
+    [TK_WHILE] = "WHILE",
+    [TK_DO] = "DO",
+    [TK_FOR] = "FOR",
+    [TK_SWITCH] = "SWITCH",
+    [TK_CASE] = "CASE",
+    [TK_DEFAULT] = "DEFAULT",
+    [TK_TRUE] = "TRUE",
+    [TK_FALSE] = "FALSE",
+    [TK_ID] = "ID",
+    [TK_NUM] = "NUM",
+    [TK_STR] = "STRING",
+    [TK_PLUS] = "PLUS",
+    [TK_MINUS] = "MINUS",
+    [TK_MUL] = "MUL",
+    [TK_DIV] = "DIV",
+    [TK_ASSIGN] = "ASSIGN",
+    [TK_EQ] = "EQ",
+    [TK_NE] = "NE",
+    [TK_LT] = "LT",
+    [TK_LE] = "LE",
+    [TK_GT] = "GT",
+    [TK_GE] = "GE",
+    [TK_LPAREN] = "LPAREN",
+    [TK_RPAREN] = "RPAREN",
+    [TK_LBRACE] = "LBRACE",
+    [TK_RBRACE] = "RBRACE",
+    [TK_SEMICOLON] = "SEMICOLON",
+    [TK_COMMA] = "COMMA",
+    [TK_COLON] = "COLON",
+    [TK_EOF] = "EOF",
+    [TK_ERROR] = "ERROR",
+};
+
+#endif
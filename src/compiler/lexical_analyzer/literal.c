@@ -0,0 +1,229 @@
+#include "literal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define MAX_SIG_DIGITS 19       // uint64能放下的十进制位数
+#define PAGE_BITS 12
+#define PAGE_SIZE (1 << PAGE_BITS)
+#define MAX_PAGES (1 << 14)
+#define SHARD_BITS 4
+#define SHARD_COUNT (1 << SHARD_BITS)   // 按哈希最高几位分片，每片一把锁
+
+// ==================== 解析 ====================
+
+// double能精确表示的10的幂
+static const double exact_powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 难以快速判定的情况交给strtod（结果正确舍入）
+static int parse_float_slow(const char* text, size_t length, double* value) {
+    char local[64];
+    char* copy = length < sizeof(local) ? local : (char*)malloc(length + 1);
+    if (!copy) return 0;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    *value = strtod(copy, NULL);
+    if (copy != local) free(copy);
+    return !isinf(*value);
+}
+
+// 解析数字字面量：一遍扫描得到最多19位有效数字和10的指数，
+// 小数在尾数和指数都足够小时直接用一次浮点乘除得到正确舍入的结果（Clinger快速路径）
+int parse_number(const char* text, size_t length, NumLiteral* out) {
+    const char* p = text;
+    const char* end = text + length;
+    uint64_t mantissa = 0;
+    int digits = 0;         // 已计入尾数的有效数字
+    int exponent = 0;       // 值 = mantissa * 10^exponent
+    int truncated = 0;      // 有被丢弃的非零数字
+    
+    // 整数部分
+    for (; p < end && *p != '.'; p++) {
+        unsigned d = (unsigned)(*p - '0');
+        if (digits < MAX_SIG_DIGITS) {
+            mantissa = mantissa * 10 + d;
+            if (mantissa != 0) digits++;
+        } else {
+            exponent++;
+            truncated |= d != 0;
+        }
+    }
+    
+    if (p == end) {
+        // 整数
+        if (exponent > 0 || mantissa > (uint64_t)INT64_MAX) return 0;
+        out->kind = NUM_INT;
+        out->int_value = (int64_t)mantissa;
+        return 1;
+    }
+    
+    // 小数部分
+    for (p++; p < end; p++) {
+        unsigned d = (unsigned)(*p - '0');
+        if (digits < MAX_SIG_DIGITS) {
+            mantissa = mantissa * 10 + d;
+            exponent--;
+            if (mantissa != 0) digits++;
+        } else {
+            truncated |= d != 0;
+        }
+    }
+    
+    out->kind = NUM_FLOAT;
+#if FLT_EVAL_METHOD == 0
+    if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double m = (double)mantissa;
+        out->float_value = exponent < 0 ? m / exact_powers[-exponent] : m * exact_powers[exponent];
+        return 1;
+    }
+#endif
+    return parse_float_slow(text, length, &out->float_value);
+}
+
+// ==================== 字面量表 ====================
+
+// 相同的值只存一份，大量重复的数字（以及流式分析很长的文件）不会让表一直增长。
+// 表按值的哈希分片加锁，编号表按页分配，已发布的条目不会移动。
+
+// 分片哈希表的槽位（index为0表示空槽）
+typedef struct {
+    uint32_t hash;
+    uint32_t index;
+} LiteralSlot;
+
+typedef struct {
+    pthread_mutex_t lock;
+    LiteralSlot* slots;
+    uint32_t capacity;
+    uint32_t count;
+} LiteralShard;
+
+#define SHARD_INIT { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0 }
+
+static LiteralShard shards[SHARD_COUNT] = {
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT,
+    SHARD_INIT, SHARD_INIT, SHARD_INIT, SHARD_INIT
+};
+
+static _Atomic(NumLiteral*) pages[MAX_PAGES];
+static pthread_mutex_t page_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint next_index = 1;
+
+// 值的哈希（种类和64位内容）
+static uint32_t literal_hash(NumLiteral literal) {
+    uint64_t bits = (uint64_t)literal.int_value;     // double按位取
+    bits ^= (uint64_t)literal.kind << 63;
+    bits *= 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(bits >> 32);
+}
+
+static int literal_equal(NumLiteral a, NumLiteral b) {
+    return a.kind == b.kind && a.int_value == b.int_value;
+}
+
+// 编号对应的条目位置（所在页不存在时分配）
+static NumLiteral* entry_slot(uint32_t index) {
+    uint32_t page = index >> PAGE_BITS;
+    if (page >= MAX_PAGES) return NULL;
+    
+    NumLiteral* entries = atomic_load_explicit(&pages[page], memory_order_acquire);
+    if (!entries) {
+        pthread_mutex_lock(&page_lock);
+        entries = atomic_load_explicit(&pages[page], memory_order_relaxed);
+        if (!entries) {
+            entries = (NumLiteral*)calloc(PAGE_SIZE, sizeof(NumLiteral));
+            atomic_store_explicit(&pages[page], entries, memory_order_release);
+        }
+        pthread_mutex_unlock(&page_lock);
+        if (!entries) return NULL;
+    }
+    return &entries[index & (PAGE_SIZE - 1)];
+}
+
+// 扩大分片的哈希表（持有分片锁时调用）
+static int grow_shard(LiteralShard* shard) {
+    uint32_t capacity = shard->capacity ? shard->capacity * 2 : 256;
+    LiteralSlot* slots = (LiteralSlot*)calloc(capacity, sizeof(LiteralSlot));
+    if (!slots) return 0;
+    
+    for (uint32_t i = 0; i < shard->capacity; i++) {
+        if (shard->slots[i].index == LITERAL_NONE) continue;
+        uint32_t j = shard->slots[i].hash & (capacity - 1);
+        while (slots[j].index != LITERAL_NONE) j = (j + 1) & (capacity - 1);
+        slots[j] = shard->slots[i];
+    }
+    free(shard->slots);
+    shard->slots = slots;
+    shard->capacity = capacity;
+    return 1;
+}
+
+// 添加字面量，返回编号；0 <= 值 < 2^31的整数直接放在编号里，不进表
+uint32_t literal_add(NumLiteral literal) {
+    if (literal.kind == NUM_INT && literal.int_value >= 0 && literal.int_value < (int64_t)LITERAL_INLINE) {
+        return LITERAL_INLINE | (uint32_t)literal.int_value;
+    }
+    
+    uint32_t hash = literal_hash(literal);
+    LiteralShard* shard = &shards[hash >> (32 - SHARD_BITS)];
+    uint32_t index = LITERAL_NONE;
+    
+    pthread_mutex_lock(&shard->lock);
+    
+    // 装载因子保持在1/2以下
+    if ((shard->count + 1) * 2 > shard->capacity && !grow_shard(shard)) {
+        pthread_mutex_unlock(&shard->lock);
+        return LITERAL_NONE;
+    }
+    
+    uint32_t mask = shard->capacity - 1;
+    uint32_t i = hash & mask;
+    while (shard->slots[i].index != LITERAL_NONE) {
+        if (shard->slots[i].hash == hash && literal_equal(literal_get(shard->slots[i].index), literal)) {
+            index = shard->slots[i].index;
+            pthread_mutex_unlock(&shard->lock);
+            return index;
+        }
+        i = (i + 1) & mask;
+    }
+    
+    // 新的值：先写好条目，再放进哈希表
+    uint32_t new_index = atomic_fetch_add_explicit(&next_index, 1, memory_order_relaxed);
+    NumLiteral* entry = entry_slot(new_index);
+    if (entry) {
+        *entry = literal;
+        shard->slots[i].hash = hash;
+        shard->slots[i].index = new_index;
+        shard->count++;
+        index = new_index;
+    }
+    
+    pthread_mutex_unlock(&shard->lock);
+    return index;
+}
+
+// 按编号取字面量（不是literal_add返回的编号时得到整数0）
+NumLiteral literal_get(uint32_t index) {
+    NumLiteral literal = { NUM_INT, { 0 } };
+    if (index & LITERAL_INLINE) {
+        literal.int_value = index & ~LITERAL_INLINE;
+        return literal;
+    }
+    if (index == LITERAL_NONE || index >= atomic_load_explicit(&next_index, memory_order_relaxed)) return literal;
+    
+    NumLiteral* entries = atomic_load_explicit(&pages[index >> PAGE_BITS], memory_order_acquire);
+    return entries ? entries[index & (PAGE_SIZE - 1)] : literal;
+}
+
+// 已分配的表编号的上界
+uint32_t literal_count() {
+    return atomic_load_explicit(&next_index, memory_order_relaxed) - 1;
+}
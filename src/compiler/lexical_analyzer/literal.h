@@ -0,0 +1,38 @@
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 数字字面量
+// 词法分析时一次解析出带类型的值放进字面量表，NUM Token的value是表中的编号，
+// 之后的分析直接取值，不再解析文本。
+
+typedef enum {
+    NUM_INT,        // 整数（int64）
+    NUM_FLOAT       // 小数（double）
+} NumKind;
+
+typedef struct {
+    NumKind kind;
+    union {
+        int64_t int_value;
+        double float_value;
+    };
+} NumLiteral;
+
+// 解析 digits 或 digits.digits，超出int64/double范围时返回0
+int parse_number(const char* text, size_t length, NumLiteral* out);
+
+// 字面量表（整个进程共用，可以多线程同时添加）
+// 相同的值得到同一编号；非负且小于2^31的整数不占表项，编号是值加上LITERAL_INLINE。
+#define LITERAL_NONE 0                  // 无效编号：表已满或内存不足
+#define LITERAL_INLINE 0x80000000u      // 编号最高位为1表示值就在编号里
+
+uint32_t literal_add(NumLiteral literal);
+NumLiteral literal_get(uint32_t index);
+
+// 已分配的表编号的上界（表编号都不超过它，不含直接放在编号里的整数）
+uint32_t literal_count();
+
+#endif
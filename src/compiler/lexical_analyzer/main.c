@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "scanner.h"
 
 int main(int argc, char* argv[]) {
@@ -10,9 +11,18 @@ int main(int argc, char* argv[]) {
     const char* input_file = "input.txt";
     const char* output_file = "output.txt";
     
-    // 打开输入文件
-    FILE* input = fopen(input_file, "r");
-    if (!input) {
+    // 默认内存映射输入文件；--stream 时分块读入，内存占用与文件大小无关
+    int streaming = argc > 1 && strcmp(argv[1], "--stream") == 0;
+    FILE* input = NULL;
+    if (streaming) {
+        input = fopen(input_file, "rb");
+        if (!input || !init_scanner_chunked(input, SCANNER_CHUNK_SIZE)) {
+            printf("错误：无法打开输入文件 %s\n", input_file);
+            if (input) fclose(input);
+            return 1;
+        }
+    }
+    else if (!init_scanner_file(input_file)) {
         printf("错误：无法打开输入文件 %s\n", input_file);
         return 1;
     }
@@ -21,21 +31,23 @@ int main(int argc, char* argv[]) {
     FILE* output = fopen(output_file, "w");
     if (!output) {
         printf("错误：无法打开输出文件 %s\n", output_file);
-        fclose(input);
+        close_scanner();
+        if (input) fclose(input);
         return 1;
     }
     
+    // 遇到词法错误时跳过出错的片段继续分析，最后一次报告全部错误
+    set_scanner_recovery(1);
+    
     printf("输入文件: %s\n", input_file);
     printf("输出文件: %s\n\n", output_file);
     
-    // 初始化词法分析器
-    init_scanner(input);
-    
     printf("开始词法分析...\n");
     printf("────────────────────────────────────────\n");
     
     Token token;
     int token_count = 0;
+    int line, column;
     
     // 逐个获取并打印Token
     do {
@@ -46,28 +58,36 @@ int main(int argc, char* argv[]) {
         print_token(token);
         
         // 写入到文件
+        get_token_position(token, &line, &column);
         fprintf(output, "Line %3d, Col %3d: %-10s", 
-                token.line, token.column, 
+                line, column, 
                 token_type_to_string(token.type));
         
         if (token.type == TK_ID || token.type == TK_NUM || token.type == TK_STR) {
-            fprintf(output, "  '%s'", token.lexeme);
+            fprintf(output, "  '%.*s'", (int)token.length, get_token_start(token));
         }
         fprintf(output, "\n");
         
-    } while (token.type != TK_EOF && token.type != TK_ERROR);
+    } while (token.type != TK_EOF);
     
     printf("────────────────────────────────────────\n");
     printf("词法分析完成！\n");
     printf("总共识别了 %d 个Token\n\n", token_count);
     
-    if (token.type == TK_ERROR) {
-        printf("⚠️  发现错误：%s\n", token.lexeme);
+    uint32_t error_count;
+    const LexDiagnostic* errors = get_lex_diagnostics(&error_count);
+    if (error_count > 0) {
+        printf("⚠️  发现 %u 个词法错误：\n", error_count);
+        for (uint32_t i = 0; i < error_count; i++) {
+            printf("  Line %3d, Col %3d: %s  '%s'\n", errors[i].line, errors[i].column,
+                   lex_error_message(errors[i].code), errors[i].text);
+        }
+        printf("\n");
     }
     
     // 清理资源
     close_scanner();
-    fclose(input);
+    if (input) fclose(input);
     fclose(output);
     
     printf("结果已保存到: %s\n", output_file);
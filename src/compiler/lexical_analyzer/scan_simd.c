@@ -0,0 +1,372 @@
+#include "scan_simd.h"
+#include "unicode.h"
+#include <stddef.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+// ==================== 逐字节实现 ====================
+
+// 空白字符：空格 \t \n \v \f \r
+static int is_space_byte(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+// 标识符字符：字母、数字、下划线
+static int is_ident_byte(unsigned char c) {
+    return (unsigned char)((c | 0x20) - 'a') < 26 ||
+           (unsigned char)(c - '0') < 10 || c == '_';
+}
+
+static const char* scalar_whitespace_end(const char* p, const char* end) {
+    while (p < end && is_space_byte((unsigned char)*p)) p++;
+    return p;
+}
+
+static const char* scalar_ident_end(const char* p, const char* end) {
+    while (p < end && is_ident_byte((unsigned char)*p)) p++;
+    return p;
+}
+
+static const char* scalar_block_comment_end(const char* p, const char* end) {
+    while (end - p >= 2) {
+        if (p[0] == '*' && p[1] == '/') return p;
+        p++;
+    }
+    return end;
+}
+
+static size_t scalar_line_starts(const char* p, const char* end, uint32_t base, uint32_t* out) {
+    size_t n = 0;
+    for (const char* q = p; q < end; q++) {
+        if (*q == '\n') out[n++] = base + (uint32_t)(q - p) + 1;
+    }
+    return n;
+}
+
+static const char* scalar_utf8_invalid(const char* p, const char* end) {
+    uint32_t code_point;
+    while (p < end) {
+        if ((unsigned char)*p < 0x80) {
+            p++;
+            continue;
+        }
+        int n = utf8_decode(p, end, &code_point);
+        if (n <= 0) return p;
+        p += n;
+    }
+    return p;
+}
+
+static const ScanKernels scalar_kernels = {
+    "scalar",
+    scalar_whitespace_end,
+    scalar_ident_end,
+    scalar_block_comment_end,
+    scalar_line_starts,
+    scalar_utf8_invalid
+};
+
+const ScanKernels* scan_kernels_scalar() {
+    return &scalar_kernels;
+}
+
+#ifdef SCAN_HAVE_X86
+
+// ==================== SSE2实现（16字节） ====================
+
+#define SSE2 __attribute__((target("sse2")))
+
+// c在[lo, lo+width]范围内的字节置为0xFF（无符号比较：min(c-lo, width) == c-lo）
+SSE2 static inline __m128i sse2_in_range(__m128i v, char lo, char width) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(width)), shifted);
+}
+
+SSE2 static inline __m128i sse2_is_space(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                        sse2_in_range(v, '\t', '\r' - '\t'));
+}
+
+SSE2 static inline __m128i sse2_is_ident(__m128i v) {
+    __m128i alpha = sse2_in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 25);
+    __m128i digit = sse2_in_range(v, '0', 9);
+    __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+}
+
+SSE2 static const char* sse2_whitespace_end(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(sse2_is_space(v)) & 0xFFFF;
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scalar_whitespace_end(p, end);
+}
+
+SSE2 static const char* sse2_ident_end(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(sse2_is_ident(v)) & 0xFFFF;
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scalar_ident_end(p, end);
+}
+
+// 同时比较 p[i]=='*' 和 p[i+1]=='/'
+SSE2 static const char* sse2_block_comment_end(const char* p, const char* end) {
+    while (end - p >= 17) {
+        __m128i star = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi8('*'));
+        __m128i slash = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 1)), _mm_set1_epi8('/'));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(star, slash));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return scalar_block_comment_end(p, end);
+}
+
+// 一次比较16个字节，按掩码中置位的位置逐个写出
+SSE2 static size_t sse2_line_starts(const char* p, const char* end, uint32_t base, uint32_t* out) {
+    const char* q = p;
+    size_t n = 0;
+    while (end - q >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)q);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        uint32_t at = base + (uint32_t)(q - p) + 1;
+        while (mask) {
+            out[n++] = at + (uint32_t)__builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+        q += 16;
+    }
+    return n + scalar_line_starts(q, end, base + (uint32_t)(q - p), out + n);
+}
+
+// 全是ASCII的16字节整块跳过，遇到非ASCII字节时逐个字符解码，直到回到ASCII
+SSE2 static const char* sse2_utf8_invalid(const char* p, const char* end) {
+    uint32_t code_point;
+    while (end - p >= 16) {
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)p));
+        if (!mask) {
+            p += 16;
+            continue;
+        }
+        p += __builtin_ctz(mask);
+        while (p < end && (unsigned char)*p >= 0x80) {
+            int n = utf8_decode(p, end, &code_point);
+            if (n <= 0) return p;
+            p += n;
+        }
+    }
+    return scalar_utf8_invalid(p, end);
+}
+
+static const ScanKernels sse2_kernels = {
+    "sse2",
+    sse2_whitespace_end,
+    sse2_ident_end,
+    sse2_block_comment_end,
+    sse2_line_starts,
+    sse2_utf8_invalid
+};
+
+// ==================== AVX2实现（32字节） ====================
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i avx2_in_range(__m256i v, char lo, char width) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(width)), shifted);
+}
+
+AVX2 static inline __m256i avx2_is_space(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                           avx2_in_range(v, '\t', '\r' - '\t'));
+}
+
+AVX2 static inline __m256i avx2_is_ident(__m256i v) {
+    __m256i alpha = avx2_in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 25);
+    __m256i digit = avx2_in_range(v, '0', 9);
+    __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+}
+
+AVX2 static const char* avx2_whitespace_end(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(avx2_is_space(v));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return sse2_whitespace_end(p, end);
+}
+
+AVX2 static const char* avx2_ident_end(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(avx2_is_ident(v));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return sse2_ident_end(p, end);
+}
+
+AVX2 static const char* avx2_block_comment_end(const char* p, const char* end) {
+    while (end - p >= 33) {
+        __m256i star = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p),
+                                         _mm256_set1_epi8('*'));
+        __m256i slash = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + 1)),
+                                          _mm256_set1_epi8('/'));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(star, slash));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return sse2_block_comment_end(p, end);
+}
+
+AVX2 static size_t avx2_line_starts(const char* p, const char* end, uint32_t base, uint32_t* out) {
+    const char* q = p;
+    size_t n = 0;
+    while (end - q >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)q);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+        uint32_t at = base + (uint32_t)(q - p) + 1;
+        while (mask) {
+            out[n++] = at + (uint32_t)__builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+        q += 32;
+    }
+    return n + sse2_line_starts(q, end, base + (uint32_t)(q - p), out + n);
+}
+
+// UTF-8查表验证（Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"）
+// 每个字节和它前面1~3个字节的高低半字节分别查表，各种错误对应不同的位，三张表相与后非0即出错
+#define UTF8_TOO_SHORT      (1 << 0)    // 首字节后面不是续字节
+#define UTF8_TOO_LONG       (1 << 1)    // ASCII后面是续字节
+#define UTF8_OVERLONG_3     (1 << 2)    // E0 80..9F
+#define UTF8_TOO_LARGE      (1 << 3)    // 超过U+10FFFF
+#define UTF8_SURROGATE      (1 << 4)    // ED A0..BF
+#define UTF8_OVERLONG_2     (1 << 5)    // C0 C1
+#define UTF8_TOO_LARGE_1000 (1 << 6)    // F5..FF 80..8F
+#define UTF8_OVERLONG_4     (1 << 6)    // F0 80..8F
+#define UTF8_TWO_CONTS      (1 << 7)    // 两个续字节相连（是否合法由前面的首字节决定）
+#define UTF8_CARRY          (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define AVX2_TABLE16(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+AVX2 static inline __m256i avx2_high_nibble(__m256i v) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+// 整体右移n个字节，空出的位置用上一块末尾的字节填充
+#define AVX2_PREV(input, prev, n) \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - (n))
+
+AVX2 static __m256i avx2_utf8_errors(__m256i input, __m256i prev) {
+    __m256i prev1 = AVX2_PREV(input, prev, 1);
+    __m256i byte_1_high = _mm256_shuffle_epi8(AVX2_TABLE16(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4),
+        avx2_high_nibble(prev1));
+    __m256i byte_1_low = _mm256_shuffle_epi8(AVX2_TABLE16(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+        _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+    __m256i byte_2_high = _mm256_shuffle_epi8(AVX2_TABLE16(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT),
+        avx2_high_nibble(input));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+    
+    // 三字节、四字节字符的第3、4个字节必须是续字节，正好和上面TWO_CONTS的位相抵
+    __m256i third = _mm256_subs_epu8(AVX2_PREV(input, prev, 2), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(AVX2_PREV(input, prev, 3), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_continue, special);
+}
+
+// 块末尾的字符是否没有结束（最后3个字节中有需要更多续字节的首字节）
+AVX2 static inline __m256i avx2_utf8_incomplete(__m256i input) {
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    return _mm256_subs_epu8(input, max_value);
+}
+
+// 按32字节整块验证，整块ASCII时只检查上一块是否留下没结束的字符；
+// 出错的块（以及不足一块的结尾）从其中第一个字符的起始处交给逐字符解码确定位置
+AVX2 static const char* avx2_utf8_invalid(const char* p, const char* end) {
+    const char* begin = p;
+    __m256i prev = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    while (end - p >= 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i*)p);
+        __m256i error = _mm256_movemask_epi8(input) ? avx2_utf8_errors(input, prev) : incomplete;
+        if (!_mm256_testz_si256(error, error)) break;
+        incomplete = avx2_utf8_incomplete(input);
+        prev = input;
+        p += 32;
+    }
+    
+    // 退回到p所在字符的首字节（上一块末尾的字符可能跨过p）
+    for (const char* q = p; q > begin && p - q < 4; ) {
+        unsigned char c = (unsigned char)*--q;
+        if (c >= 0xC0) {
+            p = q;
+            break;
+        }
+        if (c < 0x80) break;
+    }
+    return sse2_utf8_invalid(p, end);
+}
+
+static const ScanKernels avx2_kernels = {
+    "avx2",
+    avx2_whitespace_end,
+    avx2_ident_end,
+    avx2_block_comment_end,
+    avx2_line_starts,
+    avx2_utf8_invalid
+};
+
+#endif
+
+// 运行时选择实现
+const ScanKernels* scan_kernels_detect() {
+#ifdef SCAN_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &avx2_kernels;
+    if (__builtin_cpu_supports("sse2")) return &sse2_kernels;
+#endif
+    return &scalar_kernels;
+}
@@ -0,0 +1,32 @@
+#ifndef SCAN_SIMD_H
+#define SCAN_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 扫描器的批量字符查找内核
+// 每个函数在 [p, end) 中查找一段连续字符的结束位置，
+// 一次检查16（SSE2）或32（AVX2）个字节，不支持时退回逐字节实现。
+
+typedef struct {
+    const char* name;
+    // 返回第一个非空白字符的位置
+    const char* (*whitespace_end)(const char* p, const char* end);
+    // 返回第一个不能出现在标识符中的字符的位置
+    const char* (*ident_end)(const char* p, const char* end);
+    // 返回第一个 "*/" 中 '*' 的位置，找不到返回end
+    const char* (*block_comment_end)(const char* p, const char* end);
+    // 把每个'\n'之后的位置（base + 距p的字节数 + 1）依次写入out，返回个数
+    // out至少要能放下end-p项
+    size_t (*line_starts)(const char* p, const char* end, uint32_t base, uint32_t* out);
+    // 返回第一个不是合法UTF-8的位置（包括被end截断的字符），全部合法返回end
+    const char* (*utf8_invalid)(const char* p, const char* end);
+} ScanKernels;
+
+// 根据CPU支持情况选择最快的实现（运行时检测）
+const ScanKernels* scan_kernels_detect();
+
+// 逐字节实现（用于对照和不支持SIMD的平台）
+const ScanKernels* scan_kernels_scalar();
+
+#endif
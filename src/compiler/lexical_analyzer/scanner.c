@@ -1,367 +1,880 @@
 #include "scanner.h"
+#include "keyword_hash.h"
+#include "intern.h"
+#include "literal.h"
+#include "unicode.h"
+#include <stdlib.h>
 
-// 全局变量
-static FILE* source_file = NULL;
-static int current_line = 1;
-static int current_column = 1;
-static char current_char = '\0';
-
-// 关键字表
-static Keyword keywords[] = {
-    {"begin", TK_BEGIN},
-    {"end", TK_END},
-    {"if", TK_IF},
-    {"then", TK_THEN},
-    {"else", TK_ELSE},
-    {"while", TK_WHILE},
-    {"do", TK_DO},
-    {"for", TK_FOR},
-    {"switch", TK_SWITCH},
-    {"case", TK_CASE},
-    {"default", TK_DEFAULT},
-    {"true", TK_TRUE},
-    {"false", TK_FALSE},
-    {NULL, TK_ERROR}
-};
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-// 初始化扫描器
-void init_scanner(FILE* input) {
-    source_file = input;
-    current_line = 1;
-    current_column = 1;
-    current_char = '\0';
+// ==================== 词法DFA ====================
+
+// 字符类别、状态转移表和接受状态由 gen_lexer 根据 tokens.spec 生成
+#include "lexer_tables.h"
+
+// ==================== 源缓冲区 ====================
+
+// 从缓冲区起始位置开始扫描
+static void reset_cursor(Scanner* s, const char* begin, size_t length, SourceKind kind) {
+    s->source_begin = begin;
+    s->source_cursor = begin;
+    s->source_end = begin + length;
+    s->source_kind = kind;
+    s->mapping_handle = NULL;
+    s->stream = NULL;
+    s->buffer_capacity = 0;
+    s->base_offset = 0;
+    s->current_char = length > 0 ? (unsigned char)*begin : EOF;
+    s->kernels = scan_kernels_detect();
+    s->position_cache.offset = 0;
+    s->position_cache.line = 1;
+    s->position_cache.column = 1;
+    s->line_starts = NULL;
+    s->line_count = 0;
+    s->comment_error.offset = 0;
+    s->comment_error.line = 0;
+    s->comment_error.column = 0;
+    s->diagnostics = NULL;
+    s->diagnostic_count = 0;
+    s->diagnostic_capacity = 0;
 }
 
-// 关闭扫描器
-void close_scanner() {
-    if (source_file) {
-        fclose(source_file);
-        source_file = NULL;
+// 释放由源文本推导出的表（行起始表和诊断），源文本换掉或修改后都要重建
+static void release_tables(Scanner* s) {
+    free(s->line_starts);
+    free(s->diagnostics);
+}
+
+// 一次性读入整个文件流，之后按指针扫描
+static int load_stream(Scanner* s, FILE* input) {
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    char* buffer = (char*)malloc(capacity);
+    if (!buffer) return 0;
+    
+    while (1) {
+        length += fread(buffer + length, 1, capacity - length, input);
+        if (length < capacity) break;
+    
+        char* grown = (char*)realloc(buffer, capacity * 2);
+        if (!grown) {
+            free(buffer);
+            return 0;
+        }
+        buffer = grown;
+        capacity *= 2;
     }
+    
+    reset_cursor(s, buffer, length, SOURCE_HEAP);
+    return 1;
 }
 
-// 获取下一个字符
-static char next_char() {
-    if (current_char == '\n') {
-        current_line++;
-        current_column = 1;
-    } else {
-        current_column++;
+// 内存映射整个文件（零拷贝）
+static int map_file(Scanner* s, const char* filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return 0;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        reset_cursor(s, "", 0, SOURCE_BORROWED);
+        return 1;
     }
     
-    current_char = fgetc(source_file);
-    return current_char;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return 0;
+    
+    const char* view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return 0;
+    }
+    reset_cursor(s, view, (size_t)size.QuadPart, SOURCE_MAPPED);
+    s->mapping_handle = mapping;
+    return 1;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        reset_cursor(s, "", 0, SOURCE_BORROWED);
+        return 1;
+    }
+    
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return 0;
+    
+    madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+    reset_cursor(s, (const char*)view, (size_t)st.st_size, SOURCE_MAPPED);
+    return 1;
+#endif
 }
 
-// 回退一个字符
-static void unget_char(char ch) {
-    ungetc(ch, source_file);
-    if (ch == '\n') {
-        current_line--;
-    } else {
-        current_column--;
+// 释放扫描器持有的缓冲区和推导出的表（调用者的缓冲区和文件流不在此释放）
+static void release_source(Scanner* s) {
+    release_tables(s);
+    switch (s->source_kind) {
+        case SOURCE_HEAP:
+        case SOURCE_CHUNKED:
+            free((void*)s->source_begin);
+            break;
+        case SOURCE_MAPPED:
+#ifdef _WIN32
+            UnmapViewOfFile(s->source_begin);
+            CloseHandle((HANDLE)s->mapping_handle);
+#else
+            munmap((void*)s->source_begin, (size_t)(s->source_end - s->source_begin));
+#endif
+            break;
+        default:
+            break;
     }
-    current_char = '\0';
+    reset_cursor(s, NULL, 0, SOURCE_NONE);
 }
 
-// 跳过空白字符
-static void skip_whitespace() {
-    while (isspace(current_char)) {
-        current_char = next_char();
+// 流式模式：准备第一个窗口（文件流由调用者关闭）
+static int open_chunked(Scanner* s, FILE* input, size_t chunk_size) {
+    if (chunk_size < 64) chunk_size = 64;
+    char* buffer = (char*)malloc(chunk_size);
+    if (!buffer) return 0;
+    
+    // 每次直接读入一整块，不再经过stdio自己的缓冲
+    setvbuf(input, NULL, _IONBF, 0);
+    size_t length = fread(buffer, 1, chunk_size, input);
+    
+    reset_cursor(s, buffer, length, SOURCE_CHUNKED);
+    s->stream = input;
+    s->buffer_capacity = chunk_size;
+    return 1;
+}
+
+// ==================== 扫描器对象 ====================
+
+// 创建扫描器：直接扫描调用者持有的缓冲区
+Scanner* scanner_create(const char* buffer, size_t length) {
+    Scanner* s = (Scanner*)calloc(1, sizeof(Scanner));
+    if (!s) return NULL;
+    reset_cursor(s, buffer, length, SOURCE_BORROWED);
+    return s;
+}
+
+// 创建扫描器：内存映射整个文件
+Scanner* scanner_create_from_file(const char* filename) {
+    Scanner* s = (Scanner*)calloc(1, sizeof(Scanner));
+    if (!s) return NULL;
+    if (!map_file(s, filename)) {
+        free(s);
+        return NULL;
     }
+    return s;
 }
 
-// 跳过注释
-static void skip_comment() {
-    if (current_char == '/') {
-        char next = next_char();
-        if (next == '/') {  // 单行注释
-            while (current_char != '\n' && current_char != EOF) {
-                current_char = next_char();
-            }
-            if (current_char == '\n') {
-                current_char = next_char();
-            }
+// 创建扫描器：读入整个文件流
+Scanner* scanner_create_from_stream(FILE* input) {
+    Scanner* s = (Scanner*)calloc(1, sizeof(Scanner));
+    if (!s) return NULL;
+    if (!load_stream(s, input)) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+// 创建扫描器：分块读入文件流，只保留当前窗口
+Scanner* scanner_create_chunked(FILE* input, size_t chunk_size) {
+    Scanner* s = (Scanner*)calloc(1, sizeof(Scanner));
+    if (!s) return NULL;
+    if (!open_chunked(s, input, chunk_size)) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+// 销毁扫描器
+void scanner_destroy(Scanner* s) {
+    if (!s) return;
+    release_source(s);
+    free(s);
+}
+
+// 把行列位置缓存向后推进到target（target必须在当前窗口内），列号按字符计
+static void advance_position(Scanner* s, const char* target) {
+    SourcePos* pos = &s->position_cache;
+    const char* p = s->source_begin + (pos->offset - s->base_offset);
+    if (p >= target) return;
+    
+    pos->offset += (uint64_t)(target - p);
+    while (p < target) {
+        const char* newline = memchr(p, '\n', (size_t)(target - p));
+        if (!newline) {
+            pos->column += (int)utf8_count(p, target);
+            break;
         }
-        else if (next == '*') {  // 多行注释
-            current_char = next_char();
-            while (1) {
-                if (current_char == EOF) {
-                    break;
-                }
-                if (current_char == '*') {
-                    next = next_char();
-                    if (next == '/') {
-                        current_char = next_char();
-                        break;
-                    }
-                    unget_char(next);
-                }
-                current_char = next_char();
-            }
+        pos->line++;
+        pos->column = 1;
+        p = newline + 1;
+    }
+}
+
+// 流式模式：丢弃keep_from之前的数据，剩余部分移到窗口开头，再读入下一块
+// 返回新读入的字节数；返回0时窗口保持不变，调用者手中的指针仍然有效
+static size_t refill(Scanner* s, const char* keep_from) {
+    if (!s->stream) return 0;
+    
+    // 先确认还有数据，文件读完后不再移动窗口
+    int c = getc(s->stream);
+    if (c == EOF) {
+        s->stream = NULL;
+        return 0;
+    }
+    ungetc(c, s->stream);
+    
+    // 行列位置必须在数据被丢弃之前推进
+    advance_position(s, keep_from);
+    
+    char* buffer = (char*)s->source_begin;
+    size_t kept = (size_t)(s->source_end - keep_from);
+    size_t cursor = s->source_cursor > keep_from ? (size_t)(s->source_cursor - keep_from) : 0;
+    s->base_offset += (uint64_t)(keep_from - s->source_begin);
+    memmove(buffer, keep_from, kept);
+    
+    // 单个Token比窗口还长时才扩大窗口
+    if (kept == s->buffer_capacity) {
+        char* grown = (char*)realloc(buffer, s->buffer_capacity * 2);
+        if (!grown) return 0;
+        buffer = grown;
+        s->buffer_capacity *= 2;
+    }
+    
+    size_t got = fread(buffer + kept, 1, s->buffer_capacity - kept, s->stream);
+    s->source_begin = buffer;
+    s->source_end = buffer + kept + got;
+    s->source_cursor = buffer + cursor;
+    s->current_char = s->source_cursor < s->source_end ? (unsigned char)*s->source_cursor : EOF;
+    return got;
+}
+
+// 向前查看第n个字符（不移动位置）
+static int peek_char(Scanner* s, int n) {
+    if (s->source_cursor + n >= s->source_end) {
+        refill(s, s->source_cursor);
+    }
+    return s->source_cursor + n < s->source_end ? (unsigned char)s->source_cursor[n] : EOF;
+}
+
+// 直接移动到指定位置（批量跳过一段字符）
+static void move_to(Scanner* s, const char* p) {
+    s->source_cursor = p;
+    s->current_char = p < s->source_end ? (unsigned char)*p : EOF;
+}
+
+// 跳过空白字符
+static void skip_whitespace(Scanner* s) {
+    const char* p = s->kernels->whitespace_end(s->source_cursor, s->source_end);
+    while (p == s->source_end && refill(s, p)) {
+        p = s->kernels->whitespace_end(s->source_begin, s->source_end);
+    }
+    move_to(s, p);
+}
+
+// 注释中有非法UTF-8编码（注释本身不产生Token，由scanner_next_token把整个注释作为ERROR Token报告）
+// 流式模式下注释开头可能早已移出窗口，报告用的位置和片段在它还在窗口中时记下
+typedef struct {
+    int found;          // 发现了非法编码
+    int saved;          // 下面几项已经记下
+    uint64_t comment;   // 注释起始的偏移
+    int line;           // 注释起始的行号
+    int column;         // 注释起始的列号
+    uint32_t text_length;
+    char text[16];      // 注释开头的片段（原样，不以'\0'结尾）
+} InvalidUtf8;
+
+// 片段不足16字节时接着复制[from, end)中的内容
+static void append_comment_text(InvalidUtf8* bad, const char* from, const char* end) {
+    size_t length = (size_t)(end - from);
+    size_t room = sizeof(bad->text) - bad->text_length;
+    if (length > room) length = room;
+    memcpy(bad->text + bad->text_length, from, length);
+    bad->text_length += (uint32_t)length;
+}
+
+// 记下注释开头的行列和片段（注释开头此时一定还在窗口内）
+static void save_comment_start(Scanner* s, InvalidUtf8* bad) {
+    if (bad->saved) return;
+    bad->text_length = 0;
+    append_comment_text(bad, s->source_begin + (bad->comment - s->base_offset), s->source_end);
+    scanner_offset_position(s, (uint32_t)bad->comment, &bad->line, &bad->column);
+    bad->saved = 1;
+}
+
+// 检查注释中的一段文字，只记录第一处错误
+static void check_comment_utf8(Scanner* s, const char* from, const char* to, InvalidUtf8* bad) {
+    if (bad->found) return;
+    if (s->kernels->utf8_invalid(from, to) == to) return;
+    save_comment_start(s, bad);
+    bad->found = 1;
+}
+
+// 注释跨过窗口末尾时读入下一块，只保留还没检查的keep之后的部分，from更新为keep在新窗口中的位置
+static int refill_comment(Scanner* s, const char** from, const char* keep, InvalidUtf8* bad) {
+    size_t kept = (size_t)(s->source_end - keep);
+    save_comment_start(s, bad);
+    if (!refill(s, keep)) {
+        *from = keep;
+        return 0;
+    }
+    *from = s->source_begin;
+    append_comment_text(bad, s->source_begin + kept, s->source_end);
+    return 1;
+}
+
+// 跳过注释（调用前已确认当前位置是 // 或 /*），同时检查其中的UTF-8编码
+// 换窗口前只检查到最后一个完整的字符，被截断的字符留到下一块
+static void skip_comment(Scanner* s, InvalidUtf8* bad) {
+    bad->comment = s->base_offset + (uint64_t)(s->source_cursor - s->source_begin);
+    bad->saved = 0;
+    if (peek_char(s, 1) == '/') {  // 单行注释，跳到换行符之后
+        const char* from = s->source_cursor + 2;
+        const char* newline;
+        while (!(newline = memchr(from, '\n', (size_t)(s->source_end - from)))) {
+            const char* keep = utf8_tail_start(from, s->source_end);
+            check_comment_utf8(s, from, keep, bad);
+            if (!refill_comment(s, &from, keep, bad)) break;
         }
-        else {
-            unget_char(next);  // 不是注释，回退
+        check_comment_utf8(s, from, newline ? newline : s->source_end, bad);
+        move_to(s, newline ? newline + 1 : s->source_end);
+    }
+    else {  // 多行注释，跳到 */ 之后
+        const char* from = s->source_cursor + 2;
+        const char* close;
+        while ((close = s->kernels->block_comment_end(from, s->source_end)) == s->source_end) {
+            // 窗口末尾的 '*' 可能和下一块开头的 '/' 组成 */，保留它
+            const char* keep = from < s->source_end && s->source_end[-1] == '*'
+                             ? s->source_end - 1 : utf8_tail_start(from, s->source_end);
+            check_comment_utf8(s, from, keep, bad);
+            if (!refill_comment(s, &from, keep, bad)) break;
         }
+        check_comment_utf8(s, from, close, bad);
+        move_to(s, close < s->source_end ? close + 2 : s->source_end);
     }
 }
 
-// 查找关键字
-static TokenType lookup_keyword(char* word) {
-    int i = 0;
-    while (keywords[i].word != NULL) {
-        if (strcmp(word, keywords[i].word) == 0) {
-            return keywords[i].type;
+// 判断当前位置是否为注释开始
+static int at_comment(Scanner* s) {
+    return s->current_char == '/' && (peek_char(s, 1) == '/' || peek_char(s, 1) == '*');
+}
+
+// 恢复模式：记录一个词法错误，行列和片段由调用者给出
+static void add_diagnostic(Scanner* s, Token token, int line, int column, const char* text, size_t length) {
+    if (s->diagnostic_count == s->diagnostic_capacity) {
+        uint32_t capacity = s->diagnostic_capacity ? s->diagnostic_capacity * 2 : 16;
+        LexDiagnostic* grown = (LexDiagnostic*)realloc(s->diagnostics, capacity * sizeof(LexDiagnostic));
+        if (!grown) return;
+        s->diagnostics = grown;
+        s->diagnostic_capacity = capacity;
+    }
+    
+    LexDiagnostic* d = &s->diagnostics[s->diagnostic_count++];
+    d->code = (LexError)token.value;
+    d->offset = token.offset;
+    d->length = token.length;
+    d->line = line;
+    d->column = column;
+    if (length > sizeof(d->text) - 1) length = sizeof(d->text) - 1;
+    memcpy(d->text, text, length);
+    d->text[length] = '\0';
+    
+    // 截断处不完整的字符去掉，非法编码换成'?'，保证片段可以直接打印
+    char* end = d->text + strlen(d->text);
+    char* q = d->text;
+    while ((q = (char*)s->kernels->utf8_invalid(q, end)) < end) {
+        uint32_t code_point;
+        if (utf8_decode(q, end, &code_point) < 0) {
+            *q = '\0';
+            break;
         }
-        i++;
+        int n = utf8_invalid_length(q, end);
+        memset(q, '?', (size_t)n);
+        q += n;
     }
-    return TK_ID;  // 不是关键字，是标识符
+}
+
+// 恢复模式：记录一个词法错误（出错片段此时一定还在窗口内）
+static void record_diagnostic(Scanner* s, Token token, const char* start) {
+    int line, column;
+    scanner_offset_position(s, token.offset, &line, &column);
+    add_diagnostic(s, token, line, column, start, token.length);
+}
+
+// 非法字符的长度：不能开始任何Token的ASCII字符，或者不能开始标识符的非ASCII字符；
+// 不是这样的字符返回0，到达窗口末尾或字符被截断返回-1
+static int stray_length(const char* p, const char* end) {
+    if (p >= end) return -1;
+    unsigned char c = (unsigned char)*p;
+    if (c < 0x80) return lexer_stray[c];
+    
+    uint32_t code_point;
+    int n = utf8_decode(p, end, &code_point);
+    if (n < 0) return -1;
+    return n > 0 && !unicode_is_xid_start(code_point) ? n : 0;
 }
 
 // 获取下一个Token
-Token get_next_token() {
+Token scanner_next_token(Scanner* s) {
     Token token;
     
     // 跳过空白和注释
-    do {
-        if (current_char == '\0') {
-            current_char = next_char();
-        }
-        skip_whitespace();
-        if (current_char == '/') {
-            skip_comment();
-        }
-    } while (isspace(current_char) || current_char == '/');
+    InvalidUtf8 bad = { 0 };
+    skip_whitespace(s);
+    while (at_comment(s)) {
+        skip_comment(s, &bad);
+        if (bad.found) break;
+        skip_whitespace(s);
+    }
     
     // 初始化token
-    token.line = current_line;
-    token.column = current_column;
-    token.lexeme[0] = '\0';
+    const char* start = s->source_cursor;
+    token.length = 0;
+    token.value = 0;
     
-    // 检查文件结束
-    if (current_char == EOF) {
-        token.type = TK_EOF;
-        strcpy(token.lexeme, "EOF");
+    // 注释中有非法编码：整个注释作为一个ERROR Token（Token总是从扫描器没有中间状态的位置开始），
+    // 位置和诊断都用注释开头时记下的内容
+    if (bad.found) {
+        token.type = TK_ERROR;
+        token.value = LEX_ERR_INVALID_UTF8;
+        token.offset = (uint32_t)bad.comment;
+        token.length = (uint32_t)(s->base_offset + (uint64_t)(start - s->source_begin) - bad.comment);
+        s->comment_error.offset = bad.comment;
+        s->comment_error.line = bad.line;
+        s->comment_error.column = bad.column;
+        if (s->recovery) {
+            size_t length = bad.text_length < token.length ? bad.text_length : token.length;
+            add_diagnostic(s, token, bad.line, bad.column, bad.text, length);
+        }
         return token;
     }
     
-    // 识别标识符或关键字
-    if (isalpha(current_char) || current_char == '_') {
-        int i = 0;
-        while (isalnum(current_char) || current_char == '_') {
-            if (i < 255) {
-                token.lexeme[i++] = current_char;
-            }
-            current_char = next_char();
-        }
-        token.lexeme[i] = '\0';
-        
-        // 查找是否为关键字
-        token.type = lookup_keyword(token.lexeme);
+    // 检查文件结束
+    if (s->current_char == EOF) {
+        token.offset = (uint32_t)(s->base_offset + (uint64_t)(start - s->source_begin));
+        token.type = TK_EOF;
         return token;
     }
     
-    // 识别数字
-    if (isdigit(current_char)) {
-        int i = 0;
-        token.int_value = 0;
-        
-        while (isdigit(current_char)) {
-            if (i < 255) {
-                token.lexeme[i++] = current_char;
-                token.int_value = token.int_value * 10 + (current_char - '0');
+    // 运行DFA直到没有转移（最长匹配），标识符的剩余部分交给批量查找内核
+    const unsigned char* p = (const unsigned char*)start;
+    int state = LEXER_START;
+    while (1) {
+        const unsigned char* end = (const unsigned char*)s->source_end;
+        while (p < end) {
+            int next = lexer_next[state][lexer_class[*p]];
+            if (next == LEXER_STOP) break;
+            state = next;
+            p++;
+            if (state == LEXER_IDENT) {
+                p = (const unsigned char*)s->kernels->ident_end((const char*)p, (const char*)end);
             }
-            current_char = next_char();
         }
-        
-        // 处理浮点数（可选）
-        if (current_char == '.') {
-            token.lexeme[i++] = '.';
-            current_char = next_char();
-            while (isdigit(current_char)) {
-                if (i < 255) {
-                    token.lexeme[i++] = current_char;
-                }
-                current_char = next_char();
+    
+        // 非ASCII字符：解码后按XID属性决定能否开始或接在标识符中（只在这两个状态下继续）
+        if (p < end) {
+            if (*p < 0x80 || (state != LEXER_START && state != LEXER_IDENT)) break;
+            uint32_t code_point;
+            int n = utf8_decode((const char*)p, (const char*)end, &code_point);
+            if (n == 0) break;
+            if (n > 0) {
+                if (state == LEXER_START ? !unicode_is_xid_start(code_point)
+                                     : !unicode_is_xid_continue(code_point)) break;
+                p += n;
+                state = LEXER_IDENT;
+                continue;
             }
+            // 字符被窗口截断，和到达窗口末尾一样读入下一块再解码
         }
-        
-        token.lexeme[i] = '\0';
-        token.type = TK_NUM;
-        return token;
+    
+        // 到达窗口末尾时Token可能还没结束：保留已读部分，读入下一块继续
+        size_t consumed = (size_t)((const char*)p - start);
+        if (!refill(s, start)) break;
+        start = s->source_begin;
+        p = (const unsigned char*)start + consumed;
     }
+    token.offset = (uint32_t)(s->base_offset + (uint64_t)(start - s->source_begin));
     
-    // 识别字符串
-    if (current_char == '"') {
-        int i = 0;
-        token.lexeme[i++] = '"';
-        current_char = next_char();
-        
-        while (current_char != '"' && current_char != EOF) {
-            // 处理转义字符
-            if (current_char == '\\') {
-                token.lexeme[i++] = '\\';
-                current_char = next_char();
-                switch (current_char) {
-                    case 'n': token.lexeme[i++] = 'n'; break;
-                    case 't': token.lexeme[i++] = 't'; break;
-                    case '\\': token.lexeme[i++] = '\\'; break;
-                    case '"': token.lexeme[i++] = '"'; break;
-                    default: token.lexeme[i++] = current_char; break;
-                }
+    token.type = lexer_accept[state];
+    if (token.type == 0) {
+        // 停在非接受状态：字符串未结束，或者是非法字符
+        // 跳过出错的片段后继续分析：未结束的字符串只占到行尾，连续的非法字符合成一个
+        token.type = TK_ERROR;
+        if (lexer_pending[state] == TK_STR) {
+            token.value = LEX_ERR_UNTERMINATED_STRING;
+            const char* newline = memchr(start, '\n', (size_t)((const char*)p - start));
+            if (newline) p = (const unsigned char*)newline;
+        } else {
+            int n = stray_length(start, s->source_end);
+            if (n <= 0 && (unsigned char)*start >= 0x80) {
+                token.value = LEX_ERR_INVALID_UTF8;
+                p = (const unsigned char*)start + utf8_invalid_length(start, s->source_end);
             } else {
-                token.lexeme[i++] = current_char;
+                token.value = LEX_ERR_UNEXPECTED_CHAR;
+                p = (const unsigned char*)start + (n > 0 ? n : 1);
+                while (1) {
+                    while ((n = stray_length((const char*)p, s->source_end)) > 0) p += n;
+                    if (n == 0) break;
+    
+                    // 到达窗口末尾：读入下一块继续合并，和一次读入整个文件的结果一致
+                    size_t consumed = (size_t)((const char*)p - start);
+                    if (!refill(s, start)) break;
+                    start = s->source_begin;
+                    p = (const unsigned char*)start + consumed;
+                }
             }
-            
-            if (i >= 254) break;  // 防止溢出
-            current_char = next_char();
         }
-        
-        if (current_char == '"') {
-            token.lexeme[i++] = '"';
-            token.lexeme[i] = '\0';
-            token.type = TK_STR;
-            current_char = next_char();
+    }
+    token.length = (uint32_t)((const char*)p - start);
+    move_to(s, (const char*)p);
+    
+    if (token.type == TK_ID) {
+        // 查找是否为关键字（生成的完美哈希表），普通标识符取驻留编号
+        token.type = keyword_lookup(start, token.length);
+        if (token.type == TK_ID) token.value = intern(start, token.length);
+    }
+    else if (token.type == TK_STR) {
+        // 字符串内容原样保留，只检查编码是否合法
+        if (s->kernels->utf8_invalid(start, (const char*)p) != (const char*)p) {
+            token.type = TK_ERROR;
+            token.value = LEX_ERR_INVALID_UTF8;
         } else {
+            token.value = intern(start, token.length);
+        }
+    }
+    else if (token.type == TK_NUM) {
+        // 解析出带类型的值放进字面量表
+        NumLiteral number;
+        if (!parse_number(start, token.length, &number)) {
+            token.type = TK_ERROR;
+            token.value = LEX_ERR_NUMBER_OVERFLOW;
+        } else if ((token.value = literal_add(number)) == LITERAL_NONE) {
             token.type = TK_ERROR;
-            strcpy(token.lexeme, "Unterminated string");
+            token.value = LEX_ERR_TOO_MANY_LITERALS;
         }
-        return token;
     }
     
-    // 识别运算符和分隔符
-    token.lexeme[0] = current_char;
-    token.lexeme[1] = '\0';
-    
-    switch (current_char) {
-        case '+': token.type = TK_PLUS; break;
-        case '-': token.type = TK_MINUS; break;
-        case '*': token.type = TK_MUL; break;
-        case '/': token.type = TK_DIV; break;
-        
-        case '=':
-            token.type = TK_ASSIGN;
-            current_char = next_char();
-            if (current_char == '=') {
-                token.type = TK_EQ;
-                token.lexeme[1] = '=';
-                token.lexeme[2] = '\0';
-                current_char = next_char();
-            }
-            break;
-            
-        case '<':
-            token.type = TK_LT;
-            current_char = next_char();
-            if (current_char == '=') {
-                token.type = TK_LE;
-                token.lexeme[1] = '=';
-                token.lexeme[2] = '\0';
-                current_char = next_char();
-            } else if (current_char == '>') {
-                token.type = TK_NE;
-                token.lexeme[1] = '>';
-                token.lexeme[2] = '\0';
-                current_char = next_char();
-            }
-            break;
-            
-        case '>':
-            token.type = TK_GT;
-            current_char = next_char();
-            if (current_char == '=') {
-                token.type = TK_GE;
-                token.lexeme[1] = '=';
-                token.lexeme[2] = '\0';
-                current_char = next_char();
-            }
-            break;
-            
-        case '!':
-            current_char = next_char();
-            if (current_char == '=') {
-                token.type = TK_NE;
-                strcpy(token.lexeme, "!=");
-                current_char = next_char();
-            } else {
-                token.type = TK_ERROR;
-            }
-            break;
-            
-        case '(': token.type = TK_LPAREN; break;
-        case ')': token.type = TK_RPAREN; break;
-        case '{': token.type = TK_LBRACE; break;
-        case '}': token.type = TK_RBRACE; break;
-        case ';': token.type = TK_SEMICOLON; break;
-        case ',': token.type = TK_COMMA; break;
-        case ':': token.type = TK_COLON; break;
-        
-        default:
-            token.type = TK_ERROR;
-            sprintf(token.lexeme, "Unexpected character: %c", current_char);
-            break;
+    if (token.type == TK_ERROR && s->recovery) {
+        record_diagnostic(s, token, start);
     }
+    return token;
+}
+
+// 移动到offset处继续扫描，offset应位于两个Token之间（流式模式下不可用）
+void scanner_seek(Scanner* s, uint32_t offset) {
+    move_to(s, s->source_begin + offset);
+}
+
+// 修改源文本：把offset开始的removed个字节换成inserted，扫描位置回到开头
+// 映射的文件或调用者的缓冲区先复制一份（留出余量），之后在自己的缓冲区里就地修改
+int scanner_replace(Scanner* s, uint32_t offset, uint32_t removed,
+                    const char* inserted, uint32_t inserted_length) {
+    if (s->source_kind == SOURCE_CHUNKED) return 0;
+    
+    const char* begin = s->source_begin;
+    size_t length = (size_t)(s->source_end - begin);
+    if (offset > length || removed > length - offset) return 0;
     
-    if (token.type != TK_ERROR && token.lexeme[1] == '\0') {
-        current_char = next_char();
+    size_t tail = length - offset - removed;
+    size_t new_length = length - removed + inserted_length;
+    size_t capacity = s->buffer_capacity;
+    char* buffer = (char*)begin;
+    
+    if (s->source_kind != SOURCE_HEAP || capacity < new_length) {
+        capacity = new_length + new_length / 2 + 64;
+        buffer = (char*)malloc(capacity);
+        if (!buffer) return 0;
+        memcpy(buffer, begin, offset);
+        memcpy(buffer + offset + inserted_length, begin + offset + removed, tail);
+        release_source(s);
+    } else {
+        memmove(buffer + offset + inserted_length, buffer + offset + removed, tail);
     }
+    memcpy(buffer + offset, inserted, inserted_length);
     
-    return token;
+    // 行起始表和诊断随源文本失效
+    release_tables(s);
+    reset_cursor(s, buffer, new_length, SOURCE_HEAP);
+    s->buffer_capacity = capacity;
+    return 1;
 }
 
-// Token类型转字符串
-const char* token_type_to_string(TokenType type) {
-    switch (type) {
-        case TK_BEGIN: return "BEGIN";
-        case TK_END: return "END";
-        case TK_IF: return "IF";
-        case TK_THEN: return "THEN";
-        case TK_ELSE: return "ELSE";
-        case TK_WHILE: return "WHILE";
-        case TK_DO: return "DO";
-        case TK_FOR: return "FOR";
-        case TK_SWITCH: return "SWITCH";
-        case TK_CASE: return "CASE";
-        case TK_DEFAULT: return "DEFAULT";
-        case TK_TRUE: return "TRUE";
-        case TK_FALSE: return "FALSE";
-        case TK_ID: return "ID";
-        case TK_NUM: return "NUM";
-        case TK_STR: return "STRING";
-        case TK_PLUS: return "PLUS";
-        case TK_MINUS: return "MINUS";
-        case TK_MUL: return "MUL";
-        case TK_DIV: return "DIV";
-        case TK_ASSIGN: return "ASSIGN";
-        case TK_EQ: return "EQ";
-        case TK_NE: return "NE";
-        case TK_LT: return "LT";
-        case TK_LE: return "LE";
-        case TK_GT: return "GT";
-        case TK_GE: return "GE";
-        case TK_LPAREN: return "LPAREN";
-        case TK_RPAREN: return "RPAREN";
-        case TK_LBRACE: return "LBRACE";
-        case TK_RBRACE: return "RBRACE";
-        case TK_SEMICOLON: return "SEMICOLON";
-        case TK_COMMA: return "COMMA";
-        case TK_COLON: return "COLON";
-        case TK_EOF: return "EOF";
-        case TK_ERROR: return "ERROR";
-        default: return "UNKNOWN";
+// Token在当前窗口中的起始位置（流式模式下只有最近一个Token保证还在窗口内）
+static const char* token_start(Scanner* s, Token token) {
+    return s->source_begin + (uint32_t)(token.offset - (uint32_t)s->base_offset);
+}
+
+// Token文本在源缓冲区中的位置（不复制，长度为token.length，不以'\0'结尾）
+const char* scanner_token_start(Scanner* s, Token token) {
+    return token_start(s, token);
+}
+
+// 取出Token文本（按需从源缓冲区复制，最多size-1字节）
+const char* scanner_token_text(Scanner* s, Token token, char* buffer, size_t size) {
+    if (size == 0) return buffer;
+    
+    if (token.type == TK_EOF) {
+        snprintf(buffer, size, "EOF");
+    }
+    else if (token.type == TK_ERROR && token.value == LEX_ERR_UNTERMINATED_STRING) {
+        snprintf(buffer, size, "Unterminated string");
+    }
+    else if (token.type == TK_ERROR && token.value == LEX_ERR_NUMBER_OVERFLOW) {
+        snprintf(buffer, size, "Number out of range: %.*s", (int)token.length, token_start(s, token));
+    }
+    else if (token.type == TK_ERROR && token.value == LEX_ERR_UNEXPECTED_CHAR) {
+        snprintf(buffer, size, "Unexpected character: %.*s", (int)token.length, token_start(s, token));
+    }
+    else if (token.type == TK_ERROR && token.value == LEX_ERR_TOO_MANY_LITERALS) {
+        snprintf(buffer, size, "Too many number literals: %.*s", (int)token.length, token_start(s, token));
+    }
+    else if (token.type == TK_ERROR && token.value == LEX_ERR_INVALID_UTF8) {
+        snprintf(buffer, size, "Invalid UTF-8 sequence");
+    }
+    else {
+        size_t length = token.length < size - 1 ? token.length : size - 1;
+        memcpy(buffer, token_start(s, token), length);
+        buffer[length] = '\0';
+    }
+    return buffer;
+}
+
+// 建立行起始表：按块调用换行符查找内核，整个源文本只扫描一遍
+// 每块之前保证剩余容量至少等于块长（最坏情况每个字节都是换行符）
+#define LINE_INDEX_BLOCK (64 * 1024)
+static int build_line_index(Scanner* s) {
+    const char* begin = s->source_begin;
+    const char* end = s->source_end;
+    size_t capacity = LINE_INDEX_BLOCK + 1;
+    uint32_t* starts = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    if (!starts) return 0;
+    
+    size_t count = 0;
+    starts[count++] = 0;
+    for (const char* p = begin; p < end; ) {
+        size_t block = (size_t)(end - p) < LINE_INDEX_BLOCK ? (size_t)(end - p) : LINE_INDEX_BLOCK;
+        if (capacity - count < block) {
+            size_t grown_capacity = capacity * 2;
+            uint32_t* grown = (uint32_t*)realloc(starts, grown_capacity * sizeof(uint32_t));
+            if (!grown) {
+                free(starts);
+                return 0;
+            }
+            starts = grown;
+            capacity = grown_capacity;
+        }
+        count += s->kernels->line_starts(p, p + block, (uint32_t)(p - begin), starts + count);
+        p += block;
+    }
+    
+    s->line_starts = starts;
+    s->line_count = (uint32_t)count;
+    return 1;
+}
+
+// 计算偏移处的行号列号（列号按UTF-8字符计）
+// 非流式模式在行起始表中二分查找；流式模式之前的数据已丢弃，只能从上次计算的位置向后推进
+void scanner_offset_position(Scanner* s, uint32_t offset, int* line, int* column) {
+    SourcePos* pos = &s->position_cache;
+    
+    if (s->source_kind != SOURCE_CHUNKED && (s->line_count || build_line_index(s))) {
+        uint32_t low = 0, high = s->line_count;
+        while (high - low > 1) {
+            uint32_t mid = low + (high - low) / 2;
+            if (s->line_starts[mid] <= offset) low = mid;
+            else high = mid;
+        }
+    
+        // 同一行中向后查找时从上次的位置接着数字符，很长的行不必每次从行首数起
+        uint32_t from = s->line_starts[low];
+        int count = 1;
+        if (pos->line == (int)low + 1 && pos->offset >= from && pos->offset <= offset) {
+            from = (uint32_t)pos->offset;
+            count = pos->column;
+        }
+        count += (int)utf8_count(s->source_begin + from, s->source_begin + offset);
+    
+        pos->offset = offset;
+        pos->line = (int)low + 1;
+        pos->column = count;
+        *line = pos->line;
+        *column = count;
+        return;
     }
+    
+    // 注释ERROR Token的开头可能已经移出窗口，用生成它时记下的位置
+    if (offset == (uint32_t)s->comment_error.offset && s->comment_error.line > 0) {
+        *line = s->comment_error.line;
+        *column = s->comment_error.column;
+        return;
+    }
+    
+    const char* target = s->source_begin + (uint32_t)(offset - (uint32_t)s->base_offset);
+    
+    // 要找的位置在缓存之前时从头开始（流式模式下不能回退）
+    if (target < s->source_begin + (pos->offset - s->base_offset) && s->base_offset == 0) {
+        pos->offset = 0;
+        pos->line = 1;
+        pos->column = 1;
+    }
+    advance_position(s, target);
+    
+    *line = pos->line;
+    *column = pos->column;
+}
+
+// 计算Token的行号列号
+void scanner_token_position(Scanner* s, Token token, int* line, int* column) {
+    scanner_offset_position(s, token.offset, line, column);
+}
+
+// 开启或关闭恢复模式（只影响之后的Token，已收集的诊断保留）
+void scanner_set_recovery(Scanner* s, int enabled) {
+    s->recovery = enabled;
+}
+
+// 取出收集到的词法错误（按出现顺序）
+const LexDiagnostic* scanner_diagnostics(Scanner* s, uint32_t* count) {
+    *count = s->diagnostic_count;
+    return s->diagnostics;
 }
 
 // 打印Token信息
-void print_token(Token token) {
-    printf("Line %3d, Col %3d: %-10s", token.line, token.column, 
-           token_type_to_string(token.type));
+void scanner_print_token(Scanner* s, Token token) {
+    int line, column;
+    scanner_token_position(s, token, &line, &column);
+    printf("Line %3d, Col %3d: %-10s", line, column, token_type_to_string(token.type));
     
     if (token.type == TK_ID || token.type == TK_NUM || token.type == TK_STR) {
-        printf("  '%s'", token.lexeme);
+        printf("  '%.*s'", (int)token.length, token_start(s, token));
         if (token.type == TK_NUM) {
-            printf(" (value: %d)", token.int_value);
+            NumLiteral number = literal_get(token.value);
+            if (number.kind == NUM_INT) {
+                printf(" (value: %lld)", (long long)number.int_value);
+            } else {
+                printf(" (value: %g)", number.float_value);
+            }
         }
     }
     printf("\n");
-}
\ No newline at end of file
+}
+
+// ==================== 兼容接口 ====================
+
+// 旧接口共用的默认扫描器
+static Scanner global_scanner = {
+    .source_kind = SOURCE_NONE,
+    .current_char = EOF,
+    .position_cache = { 0, 1, 1 }
+};
+
+// 初始化扫描器：读入整个文件流
+void init_scanner(FILE* input) {
+    release_source(&global_scanner);
+    if (!load_stream(&global_scanner, input)) {
+        reset_cursor(&global_scanner, "", 0, SOURCE_BORROWED);
+    }
+}
+
+// 初始化扫描器：内存映射整个文件
+int init_scanner_file(const char* filename) {
+    release_source(&global_scanner);
+    return map_file(&global_scanner, filename);
+}
+
+// 初始化扫描器：扫描调用者持有的缓冲区
+void init_scanner_buffer(const char* buffer, size_t length) {
+    release_source(&global_scanner);
+    reset_cursor(&global_scanner, buffer, length, SOURCE_BORROWED);
+}
+
+// 初始化扫描器：分块读入文件流
+int init_scanner_chunked(FILE* input, size_t chunk_size) {
+    release_source(&global_scanner);
+    return open_chunked(&global_scanner, input, chunk_size);
+}
+
+// 从默认扫描器获取下一个Token
+Token get_next_token() {
+    return scanner_next_token(&global_scanner);
+}
+
+// 取出Token文本
+const char* get_token_text(Token token, char* buffer, size_t size) {
+    return scanner_token_text(&global_scanner, token, buffer, size);
+}
+
+// Token文本在源缓冲区中的位置
+const char* get_token_start(Token token) {
+    return scanner_token_start(&global_scanner, token);
+}
+
+// 计算Token的行号列号
+void get_token_position(Token token, int* line, int* column) {
+    scanner_token_position(&global_scanner, token, line, column);
+}
+
+// 默认扫描器的恢复模式
+void set_scanner_recovery(int enabled) {
+    scanner_set_recovery(&global_scanner, enabled);
+}
+
+// 默认扫描器收集到的词法错误
+const LexDiagnostic* get_lex_diagnostics(uint32_t* count) {
+    return scanner_diagnostics(&global_scanner, count);
+}
+
+// 关闭默认扫描器
+void close_scanner() {
+    release_source(&global_scanner);
+}
+
+// Token类型转字符串
+const char* token_type_to_string(TokenType type) {
+    if (type > 0 && type < TOKEN_TYPE_COUNT && lexer_token_names[type]) return lexer_token_names[type];
+    return "UNKNOWN";
+}
+
+// 词法错误码转说明
+const char* lex_error_message(LexError code) {
+    switch (code) {
+        case LEX_ERR_UNTERMINATED_STRING: return "Unterminated string";
+        case LEX_ERR_UNEXPECTED_CHAR: return "Unexpected character";
+        case LEX_ERR_NUMBER_OVERFLOW: return "Number out of range";
+        case LEX_ERR_INVALID_UTF8: return "Invalid UTF-8";
+        case LEX_ERR_TOO_MANY_LITERALS: return "Too many number literals";
+        default: return "No error";
+    }
+}
+
+// 打印Token信息
+void print_token(Token token) {
+    scanner_print_token(&global_scanner, token);
+}
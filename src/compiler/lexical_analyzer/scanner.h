@@ -4,75 +4,112 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
+#include <stdint.h>
+#include "scan_simd.h"
 
-// Token类型枚举
+// Token类型枚举由 gen_lexer 根据 tokens.spec 生成
+#include "token_types.h"
+
+// 词法错误码（ERROR Token的value字段）
 typedef enum {
-    // 关键字
-    TK_BEGIN = 1,   // begin
-    TK_END,         // end
-    TK_IF,          // if
-    TK_THEN,        // then
-    TK_ELSE,        // else
-    TK_WHILE,       // while
-    TK_DO,          // do
-    TK_FOR,         // for
-    TK_SWITCH,      // switch
-    TK_CASE,        // case
-    TK_DEFAULT,     // default
-    TK_TRUE,        // true
-    TK_FALSE,       // false
-    
-    // 标识符和常量
-    TK_ID,          // 标识符
-    TK_NUM,         // 数字常量
-    TK_STR,         // 字符串常量
-    
-    // 运算符
-    TK_PLUS,        // +
-    TK_MINUS,       // -
-    TK_MUL,         // *
-    TK_DIV,         // /
-    TK_ASSIGN,      // = (赋值)
-    TK_EQ,          // == (等于)
-    TK_NE,          // != (不等于)
-    TK_LT,          // < (小于)
-    TK_LE,          // <= (小于等于)
-    TK_GT,          // > (大于)
-    TK_GE,          // >= (大于等于)
-    
-    // 分隔符
-    TK_LPAREN,      // (
-    TK_RPAREN,      // )
-    TK_LBRACE,      // {
-    TK_RBRACE,      // }
-    TK_SEMICOLON,   // ;
-    TK_COMMA,       // ,
-    TK_COLON,       // :
-    
-    // 特殊
-    TK_EOF,         // 文件结束
-    TK_ERROR        // 错误
-} TokenType;
+    LEX_ERR_NONE,
+    LEX_ERR_UNTERMINATED_STRING,    // 字符串未结束
+    LEX_ERR_UNEXPECTED_CHAR,        // 非法字符
+    LEX_ERR_NUMBER_OVERFLOW,        // 数字超出范围
+    LEX_ERR_INVALID_UTF8,           // 非法的UTF-8编码
+    LEX_ERR_TOO_MANY_LITERALS       // 字面量表已满或内存不足，数字没有记下值
+} LexError;
+
+// 词法诊断（恢复模式下每个ERROR Token记录一条；行列在出错时算好，流式模式下之后也能报告）
+typedef struct {
+    LexError code;      // 错误码
+    uint32_t offset;    // 出错片段的字节偏移
+    uint32_t length;    // 跳过的字节数
+    int line;           // 行号
+    int column;         // 列号
+    char text[16];      // 出错片段的开头（截断，以'\0'结尾）
+} LexDiagnostic;
 
-// Token结构体
+// Token结构体（16字节，文本不复制，只记录在源缓冲区中的位置）
 typedef struct {
     TokenType type;     // Token类型
-    char lexeme[256];   // Token字符串
-    int line;          // 行号
-    int column;        // 列号
-    int int_value;     // 数值（如果是数字）
+    uint32_t offset;    // 在源缓冲区中的字节偏移（流式模式下为文件偏移的低32位）
+    uint32_t length;    // 字节长度
+    uint32_t value;     // 附加值：NUM为字面量编号（literal.h），ID和STR为驻留编号（intern.h），ERROR为错误码
 } Token;
 
-// 关键字查找表
+// 源位置（字节偏移及对应的行号列号）
 typedef struct {
-    char* word;
-    TokenType type;
-} Keyword;
+    uint64_t offset;    // 字节偏移
+    int line;           // 行号
+    int column;         // 列号
+} SourcePos;
+
+// 源缓冲区的来源，决定释放方式
+typedef enum {
+    SOURCE_NONE,        // 未初始化
+    SOURCE_BORROWED,    // 调用者持有的缓冲区
+    SOURCE_HEAP,        // 从文件流读入的堆内存
+    SOURCE_MAPPED,      // 内存映射的文件
+    SOURCE_CHUNKED      // 分块读入的文件流（只保留当前窗口）
+} SourceKind;
+
+// 流式模式默认的分块大小
+#define SCANNER_CHUNK_SIZE (1 << 20)
+
+// 扫描器状态（每个源文件一个，互不共享，可在不同线程中并行使用）
+typedef struct {
+    const char* source_begin;   // 缓冲区（流式模式下为当前窗口）起始
+    const char* source_cursor;  // 当前字符位置
+    const char* source_end;     // 缓冲区结束
+    SourceKind source_kind;     // 缓冲区来源
+    void* mapping_handle;       // Windows文件映射句柄
+    FILE* stream;               // 流式模式的输入文件（读完后置为NULL）
+    size_t buffer_capacity;     // 自己分配的缓冲区容量（流式窗口或修改过的源文本）
+    uint64_t base_offset;       // 窗口起始处在文件中的偏移
+    int current_char;           // 当前字符（EOF表示结束）
+    const ScanKernels* kernels; // 批量跳过空白/注释/标识符的内核（运行时选择）
+    SourcePos position_cache;   // 上次计算的行列位置（流式模式从这里向后推进，否则用于同一行内接着数列号）
+    uint32_t* line_starts;      // 非流式模式：各行起始偏移（第一次查行列时建立，源文本修改后重建）
+    uint32_t line_count;        // 行数（0表示还没有建立）
+    SourcePos comment_error;    // 流式模式：最近一个注释ERROR Token的起始位置（注释开头可能已经移出窗口）
+    int recovery;               // 恢复模式：收集所有词法错误（换源文本后仍然保持）
+    LexDiagnostic* diagnostics; // 收集到的词法错误（换源文本或修改源文本后清空）
+    uint32_t diagnostic_count;
+    uint32_t diagnostic_capacity;
+} Scanner;
+
+// 扫描器对象接口
+Scanner* scanner_create(const char* buffer, size_t length);  // 扫描调用者持有的缓冲区
+Scanner* scanner_create_from_file(const char* filename);     // 内存映射整个文件
+Scanner* scanner_create_from_stream(FILE* input);            // 读入整个文件流
+Scanner* scanner_create_chunked(FILE* input, size_t chunk_size); // 分块读入，内存占用固定
+Token scanner_next_token(Scanner* s);
+void scanner_seek(Scanner* s, uint32_t offset);              // 从offset处继续扫描（非流式模式）
+int scanner_replace(Scanner* s, uint32_t offset, uint32_t removed,
+                    const char* inserted, uint32_t inserted_length); // 修改源文本（非流式模式）
+const char* scanner_token_text(Scanner* s, Token token, char* buffer, size_t size);
+const char* scanner_token_start(Scanner* s, Token token);    // Token文本的位置（长度为token.length，不复制）
+void scanner_token_position(Scanner* s, Token token, int* line, int* column);
+void scanner_offset_position(Scanner* s, uint32_t offset, int* line, int* column);
+void scanner_print_token(Scanner* s, Token token);
+void scanner_set_recovery(Scanner* s, int enabled);          // 开启后收集所有词法错误
+const LexDiagnostic* scanner_diagnostics(Scanner* s, uint32_t* count);
+void scanner_destroy(Scanner* s);
 
-// 全局函数声明
-void init_scanner(FILE* input);
+// 全局函数声明（使用默认扫描器，兼容旧代码）
+void init_scanner(FILE* input);                              // 读入整个文件流后扫描
+int init_scanner_file(const char* filename);                 // 内存映射整个文件（零拷贝）
+void init_scanner_buffer(const char* buffer, size_t length); // 扫描调用者持有的缓冲区
+int init_scanner_chunked(FILE* input, size_t chunk_size);    // 分块读入，内存占用固定
 Token get_next_token();
+const char* get_token_text(Token token, char* buffer, size_t size);
+const char* get_token_start(Token token);
+void get_token_position(Token token, int* line, int* column);
 const char* token_type_to_string(TokenType type);
+const char* lex_error_message(LexError code);
+void set_scanner_recovery(int enabled);
+const LexDiagnostic* get_lex_diagnostics(uint32_t* count);
 void print_token(Token token);
 void close_scanner();
 
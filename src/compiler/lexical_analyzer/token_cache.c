@@ -0,0 +1,418 @@
+#include "token_cache.h"
+#include "intern.h"
+#include "literal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 映射的缓存文件
+struct TokenCache {
+    const char* view;
+    size_t size;
+    void* mapping_handle;       // Windows文件映射句柄
+};
+
+// 各段在文件中的位置
+typedef struct {
+    uint64_t literals;
+    uint64_t values;
+    uint64_t lengths;
+    uint64_t fars;
+    uint64_t string_ends;
+    uint64_t deltas;
+    uint64_t kinds;
+    uint64_t strings;
+    uint64_t total;             // 文件大小
+} CacheLayout;
+
+static uint64_t align8(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+// 按头部中的数量计算各段位置（用64位计算，损坏的头部不会溢出）
+static void cache_layout(const TokenCacheHeader* h, CacheLayout* l) {
+    uint64_t at = sizeof(TokenCacheHeader);
+    l->literals = at;       at = align8(at + (uint64_t)h->literal_count * sizeof(CachedLiteral));
+    l->values = at;         at = align8(at + (uint64_t)h->token_count * sizeof(uint32_t));
+    l->lengths = at;        at = align8(at + (uint64_t)h->token_count * sizeof(uint32_t));
+    l->fars = at;           at = align8(at + (uint64_t)h->far_count * sizeof(CachedFar));
+    l->string_ends = at;    at = align8(at + (uint64_t)h->string_count * sizeof(uint32_t));
+    l->deltas = at;         at = align8(at + (uint64_t)h->token_count * sizeof(uint16_t));
+    l->kinds = at;          at = align8(at + (uint64_t)h->token_count * sizeof(uint8_t));
+    l->strings = at;        at = at + h->string_bytes;
+    l->total = at;
+}
+
+// 源文件内容的哈希：FNV-1a每次混入8个字节，乘法后把高位折回低位（否则高位的差异到不了低位）
+uint64_t token_cache_hash(const char* data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ (unsigned char)data[i]) * 1099511628211ULL;
+    }
+    return hash ^ (uint64_t)length;
+}
+
+// 源文件名后加后缀
+static char* cache_path(const char* filename) {
+    size_t length = strlen(filename);
+    char* path = (char*)malloc(length + sizeof(TOKEN_CACHE_SUFFIX));
+    if (!path) return NULL;
+    memcpy(path, filename, length);
+    memcpy(path + length, TOKEN_CACHE_SUFFIX, sizeof(TOKEN_CACHE_SUFFIX));
+    return path;
+}
+
+// 把data写到path：先写进同一目录下的临时文件，再改名替换。
+// 别的进程映射着的旧文件不受影响，几个进程同时写出时也不会互相截断，最后完整写出的那个留下
+static int replace_file(const char* path, const char* data, size_t size) {
+    static atomic_uint serial;
+    size_t length = strlen(path) + 48;
+    char* temp = (char*)malloc(length);
+    if (!temp) return 0;
+    snprintf(temp, length, "%s.%ld.%u.tmp", path, (long)getpid(), atomic_fetch_add(&serial, 1));
+    
+    FILE* out = fopen(temp, "wb");
+    int ok = out && fwrite(data, 1, size, out) == size;
+    if (out && fclose(out) != 0) ok = 0;
+#ifdef _WIN32
+    if (ok) ok = MoveFileExA(temp, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    if (ok) ok = rename(temp, path) == 0;
+#endif
+    if (out && !ok) remove(temp);
+    free(temp);
+    return ok;
+}
+
+// 只读映射缓存文件（比头部还小的文件直接当作无效）
+static TokenCache* cache_open(const char* path) {
+    TokenCache* cache = (TokenCache*)calloc(1, sizeof(TokenCache));
+    if (!cache) return NULL;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        free(cache);
+        return NULL;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(TokenCacheHeader)) {
+        CloseHandle(file);
+        free(cache);
+        return NULL;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) {
+        free(cache);
+        return NULL;
+    }
+    
+    cache->view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!cache->view) {
+        CloseHandle(mapping);
+        free(cache);
+        return NULL;
+    }
+    cache->size = (size_t)size.QuadPart;
+    cache->mapping_handle = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        free(cache);
+        return NULL;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TokenCacheHeader)) {
+        close(fd);
+        free(cache);
+        return NULL;
+    }
+    
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        free(cache);
+        return NULL;
+    }
+    cache->view = (const char*)view;
+    cache->size = (size_t)st.st_size;
+#endif
+    return cache;
+}
+
+// 释放映射的缓存文件
+void token_cache_close(TokenCache* cache) {
+    if (!cache) return;
+#ifdef _WIN32
+    UnmapViewOfFile(cache->view);
+    CloseHandle((HANDLE)cache->mapping_handle);
+#else
+    munmap((void*)cache->view, cache->size);
+#endif
+    free(cache);
+}
+
+// 用缓存文件为扫描器s的源文本建立TokenStream（成功时s归TokenStream所有，失败时s不变）
+static TokenStream* load_cache(Scanner* s, const char* filename, uint64_t hash) {
+    char* path = cache_path(filename);
+    if (!path) return NULL;
+    TokenCache* cache = cache_open(path);
+    free(path);
+    if (!cache) return NULL;
+    
+    // 头部和各段大小必须和源文件、文件大小对得上
+    const TokenCacheHeader* h = (const TokenCacheHeader*)cache->view;
+    uint64_t source_length = (uint64_t)(s->source_end - s->source_begin);
+    CacheLayout l;
+    cache_layout(h, &l);
+    if (memcmp(h->magic, TOKEN_CACHE_MAGIC, 4) != 0 || h->version != TOKEN_CACHE_VERSION ||
+        h->tables_hash != LEXER_TABLES_HASH || h->source_hash != hash || h->source_length != source_length ||
+        h->token_count == 0 || l.total != cache->size) {
+        token_cache_close(cache);
+        return NULL;
+    }
+    
+    const CachedLiteral* literals = (const CachedLiteral*)(cache->view + l.literals);
+    const uint32_t* values = (const uint32_t*)(cache->view + l.values);
+    const uint32_t* lengths = (const uint32_t*)(cache->view + l.lengths);
+    const CachedFar* fars = (const CachedFar*)(cache->view + l.fars);
+    const uint32_t* string_ends = (const uint32_t*)(cache->view + l.string_ends);
+    const uint16_t* deltas = (const uint16_t*)(cache->view + l.deltas);
+    const uint8_t* kinds = (const uint8_t*)(cache->view + l.kinds);
+    const char* strings = cache->view + l.strings;
+    
+    TokenStream* ts = (TokenStream*)calloc(1, sizeof(TokenStream));
+    uint32_t* string_map = (uint32_t*)malloc(((size_t)h->string_count + 1) * sizeof(uint32_t));
+    uint32_t* literal_map = (uint32_t*)malloc(((size_t)h->literal_count + 1) * sizeof(uint32_t));
+    if (ts) {
+        ts->offsets = (uint32_t*)malloc((size_t)h->token_count * sizeof(uint32_t));
+        ts->values = (uint32_t*)malloc((size_t)h->token_count * sizeof(uint32_t));
+    }
+    int ok = ts && string_map && literal_map && ts->offsets && ts->values;
+    
+    // 缓存中的字符串和字面量换成本进程的编号（下标0表示没有编号）
+    if (ok) {
+        string_map[0] = INTERN_NONE;
+        uint32_t from = 0;
+        for (uint32_t i = 0; ok && i < h->string_count; i++) {
+            uint32_t to = string_ends[i];
+            if (to < from || to > h->string_bytes) ok = 0;
+            else string_map[i + 1] = intern(strings + from, to - from);
+            from = to;
+        }
+    
+        literal_map[0] = 0;
+        for (uint32_t i = 0; ok && i < h->literal_count; i++) {
+            NumLiteral literal;
+            literal.kind = (NumKind)literals[i].kind;
+            literal.int_value = literals[i].int_value;     // 按位复制，double也一样
+            literal_map[i + 1] = literal_add(literal);
+            if (literal_map[i + 1] == LITERAL_NONE) ok = 0;
+        }
+    }
+    
+    // 一遍还原偏移和编号，同时检查Token是否落在源文本内、偏移是否递增
+    if (ok) {
+        uint32_t offset = 0, far = 0;
+        for (uint32_t i = 0; i < h->token_count; i++) {
+            uint32_t kind = kinds[i], value = values[i];
+            uint32_t next;
+            if (deltas[i] == TOKEN_CACHE_FAR) {
+                if (far == h->far_count || fars[far].index != i) break;
+                next = fars[far++].offset;
+            } else {
+                next = offset + deltas[i];
+            }
+            if ((i > 0 && next <= offset) || (uint64_t)next + lengths[i] > source_length ||
+                kind < TK_BEGIN || kind > TK_ERROR) break;
+            offset = next;
+    
+            if (kind == TK_ID || kind == TK_STR) {
+                if (value > h->string_count) break;
+                value = string_map[value];
+            } else if (kind == TK_NUM && !(value & LITERAL_INLINE)) {
+                if (value > h->literal_count) break;
+                value = literal_map[value];
+            }
+            ts->offsets[i] = offset;
+            ts->values[i] = value;
+            ts->count = i + 1;
+        }
+        ok = ts->count == h->token_count && far == h->far_count && kinds[ts->count - 1] == TK_EOF;
+    }
+    free(string_map);
+    free(literal_map);
+    
+    if (!ok) {
+        if (ts) {
+            free(ts->offsets);
+            free(ts->values);
+            free(ts);
+        }
+        token_cache_close(cache);
+        return NULL;
+    }
+    
+    ts->kinds = (uint8_t*)kinds;
+    ts->lengths = (uint32_t*)lengths;
+    ts->capacity = ts->count;
+    ts->cache = cache;
+    ts->scanner = s;
+    return ts;
+}
+
+// 加载filename对应的缓存
+TokenStream* token_cache_load(const char* filename) {
+    Scanner* s = scanner_create_from_file(filename);
+    if (!s) return NULL;
+    
+    TokenStream* ts = load_cache(s, filename, token_cache_hash(s->source_begin, (size_t)(s->source_end - s->source_begin)));
+    if (!ts) scanner_destroy(s);
+    return ts;
+}
+
+// 按布局在内存中拼好整个文件后一次写出
+static int write_cache(const TokenStream* ts, const char* filename, uint64_t hash) {
+    Scanner* s = ts->scanner;
+    TokenCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TOKEN_CACHE_MAGIC, 4);
+    h.version = TOKEN_CACHE_VERSION;
+    h.tables_hash = LEXER_TABLES_HASH;
+    h.source_hash = hash;
+    h.source_length = (uint64_t)(s->source_end - s->source_begin);
+    h.token_count = ts->count;
+    
+    // 本进程的驻留编号和字面量编号换成文件自己的字符串表、字面量表下标（同一字符串、同一字面量只存一次）；
+    // 直接放在编号里的小整数与进程无关，原样保存
+    uint32_t* string_index = (uint32_t*)calloc((size_t)intern_count() + 1, sizeof(uint32_t));
+    uint32_t* literal_index = (uint32_t*)calloc((size_t)literal_count() + 1, sizeof(uint32_t));
+    if (!string_index || !literal_index) {
+        free(string_index);
+        free(literal_index);
+        return 0;
+    }
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < ts->count; i++) {
+        uint32_t kind = ts->kinds[i], value = ts->values[i];
+        if ((kind == TK_ID || kind == TK_STR) && value != INTERN_NONE && !string_index[value]) {
+            string_index[value] = ++h.string_count;
+            h.string_bytes += intern_length(value);
+        } else if (kind == TK_NUM && value != LITERAL_NONE && !(value & LITERAL_INLINE) && !literal_index[value]) {
+            literal_index[value] = ++h.literal_count;
+        }
+        if (ts->offsets[i] - offset >= TOKEN_CACHE_FAR) h.far_count++;
+        offset = ts->offsets[i];
+    }
+    
+    CacheLayout l;
+    cache_layout(&h, &l);
+    char* file = (char*)calloc(1, (size_t)l.total);
+    if (!file) {
+        free(string_index);
+        free(literal_index);
+        return 0;
+    }
+    memcpy(file, &h, sizeof(h));
+    
+    CachedLiteral* literals = (CachedLiteral*)(file + l.literals);
+    uint32_t* values = (uint32_t*)(file + l.values);
+    CachedFar* fars = (CachedFar*)(file + l.fars);
+    uint32_t* string_ends = (uint32_t*)(file + l.string_ends);
+    uint16_t* deltas = (uint16_t*)(file + l.deltas);
+    char* strings = file + l.strings;
+    memcpy(file + l.lengths, ts->lengths, (size_t)ts->count * sizeof(uint32_t));
+    memcpy(file + l.kinds, ts->kinds, (size_t)ts->count * sizeof(uint8_t));
+    
+    uint32_t literals_written = 0, string_count = 0, string_bytes = 0, far = 0;
+    offset = 0;
+    for (uint32_t i = 0; i < ts->count; i++) {
+        uint32_t kind = ts->kinds[i], value = ts->values[i];
+        if ((kind == TK_ID || kind == TK_STR) && value != INTERN_NONE) {
+            uint32_t index = string_index[value];
+            if (index > string_count) {     // 第一次出现，按出现顺序编号
+                uint32_t length = intern_length(value);
+                memcpy(strings + string_bytes, intern_text(value), length);
+                string_bytes += length;
+                string_ends[string_count++] = string_bytes;
+            }
+            value = index;
+        } else if (kind == TK_NUM && value != LITERAL_NONE && !(value & LITERAL_INLINE)) {
+            uint32_t index = literal_index[value];
+            if (index > literals_written) {    // 第一次出现
+                NumLiteral literal = literal_get(value);
+                literals[literals_written].kind = (uint32_t)literal.kind;
+                literals[literals_written].int_value = literal.int_value;
+                literals_written++;
+            }
+            value = index;
+        }
+        values[i] = value;
+    
+        uint32_t delta = ts->offsets[i] - offset;
+        if (delta >= TOKEN_CACHE_FAR) {
+            deltas[i] = TOKEN_CACHE_FAR;
+            fars[far].index = i;
+            fars[far].offset = ts->offsets[i];
+            far++;
+        } else {
+            deltas[i] = (uint16_t)delta;
+        }
+        offset = ts->offsets[i];
+    }
+    free(string_index);
+    free(literal_index);
+    
+    char* path = cache_path(filename);
+    int ok = path && replace_file(path, file, (size_t)l.total);
+    free(path);
+    free(file);
+    return ok;
+}
+
+// 把TokenStream的当前内容写成缓存
+int token_cache_save(const TokenStream* ts, const char* filename) {
+    if (!ts || !ts->count || ts->scanner->source_kind == SOURCE_CHUNKED) return 0;
+    const Scanner* s = ts->scanner;
+    return write_cache(ts, filename, token_cache_hash(s->source_begin, (size_t)(s->source_end - s->source_begin)));
+}
+
+// 优先使用缓存，没有可用的缓存时分析后写出（写出失败不影响返回的结果）
+TokenStream* tokenize_file_cached(const char* filename, int threads, int* cache_hit) {
+    if (cache_hit) *cache_hit = 0;
+    Scanner* s = scanner_create_from_file(filename);
+    if (!s) return NULL;
+    
+    uint64_t hash = token_cache_hash(s->source_begin, (size_t)(s->source_end - s->source_begin));
+    TokenStream* ts = load_cache(s, filename, hash);
+    if (ts) {
+        if (cache_hit) *cache_hit = 1;
+        return ts;
+    }
+    
+    ts = tokenize_scanner_parallel(s, threads);
+    if (ts) write_cache(ts, filename, hash);
+    return ts;
+}
@@ -0,0 +1,72 @@
+#ifndef TOKEN_CACHE_H
+#define TOKEN_CACHE_H
+
+#include "token_stream.h"
+
+// Token缓存文件（源文件名后加".tok"，和源文件放在一起）
+// 源文件没有变化时直接映射缓存文件得到TokenStream，不再词法分析：
+// 类型和长度直接使用映射的内存，偏移按差值存放，加载时一遍累加还原，
+// 驻留编号和字面量编号只在本进程有效，缓存中存的是文件自己的字符串表和字面量表，加载时换成本进程的编号。
+//
+// 文件布局（本机字节序，各段按8字节对齐）：
+//   TokenCacheHeader
+//   CachedLiteral[literal_count]   数字字面量（不同的值各一个）
+//   uint32_t values[token_count]   ID/STR为字符串表下标，NUM为字面量表下标（都从1开始）或带LITERAL_INLINE的小整数，
+//                                  其他同Token.value
+//   uint32_t lengths[token_count]
+//   CachedFar[far_count]           与前一个Token的偏移差超过0xFFFE的Token
+//   uint32_t string_ends[string_count]  各字符串在字符数据中的结束位置
+//   uint16_t deltas[token_count]   与前一个Token的偏移差（0xFFFF表示到CachedFar中取）
+//   uint8_t kinds[token_count]
+//   char strings[string_bytes]     字符数据（不含'\0'）
+
+#define TOKEN_CACHE_MAGIC "TOKC"
+#define TOKEN_CACHE_VERSION 3       // 手写的扫描器代码或文件布局改变输出时加1（生成的表改变由tables_hash发现）
+#define TOKEN_CACHE_SUFFIX ".tok"
+#define TOKEN_CACHE_FAR 0xFFFF      // deltas中的转义值
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;       // 源文件内容的哈希（token_cache_hash）
+    uint64_t source_length;
+    uint32_t token_count;       // 含EOF
+    uint32_t far_count;
+    uint32_t string_count;
+    uint32_t string_bytes;
+    uint32_t literal_count;
+    uint32_t tables_hash;       // 写出时的LEXER_TABLES_HASH
+} TokenCacheHeader;
+
+typedef struct {
+    uint32_t kind;              // NumKind
+    uint32_t reserved;
+    union {
+        int64_t int_value;
+        double float_value;
+    };
+} CachedLiteral;
+
+typedef struct {
+    uint32_t index;             // Token下标（递增）
+    uint32_t offset;            // 该Token的偏移
+} CachedFar;
+
+typedef struct TokenCache TokenCache;
+
+// 源文件内容的哈希（FNV-1a，每次混入8个字节）
+uint64_t token_cache_hash(const char* data, size_t length);
+
+// 加载filename对应的缓存，缓存不存在、源文件已改变或缓存文件损坏时返回NULL
+TokenStream* token_cache_load(const char* filename);
+
+// 把TokenStream的当前内容写成filename对应的缓存，成功返回1
+int token_cache_save(const TokenStream* ts, const char* filename);
+
+// 有可用的缓存时直接加载，否则（并行）词法分析后写出缓存；cache_hit可以为NULL
+TokenStream* tokenize_file_cached(const char* filename, int threads, int* cache_hit);
+
+// 释放映射的缓存文件（由token_stream_destroy调用）
+void token_cache_close(TokenCache* cache);
+
+#endif
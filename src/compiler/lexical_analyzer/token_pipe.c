@@ -0,0 +1,137 @@
+#include "token_pipe.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define CACHE_LINE 64
+#define TOKEN_PIPE_SPINS 64         // 让出CPU之前先空转的次数
+
+// 生产者和消费者各自修改的字段分别放在不同的缓存行里，避免伪共享
+struct TokenPipe {
+    // 生产者（词法分析线程）
+    atomic_uint tail;               // 已发布的Token数（生产者写，消费者读）
+    uint32_t head_seen;             // 生产者最近看到的head
+    Scanner* lexer;
+    char pad0[CACHE_LINE];
+    
+    // 消费者（语法分析线程）
+    atomic_uint head;               // 已取走的Token数（消费者写，生产者读）
+    uint32_t read;                  // 下一个要取的位置
+    uint32_t tail_seen;             // 消费者最近看到的tail
+    Token last;                     // 最后取出的Token（EOF之后重复返回）
+    Scanner* view;
+    char pad1[CACHE_LINE];
+    
+    atomic_int stop;                // 要求词法分析线程提前退出
+    pthread_t thread;
+    Token ring[TOKEN_PIPE_CAPACITY];
+};
+
+// 等待时先空转一会儿，仍然等不到再让出CPU
+static void wait_a_little(int* spins) {
+    if (++*spins < TOKEN_PIPE_SPINS) return;
+    *spins = 0;
+    sched_yield();
+}
+
+// 词法分析线程：写满一批（或缓冲区满、到达EOF）时发布一次
+static void* lex_thread(void* arg) {
+    TokenPipe* pipe = (TokenPipe*)arg;
+    uint32_t write = 0, published = 0;
+    
+    while (1) {
+        Token token = scanner_next_token(pipe->lexer);
+    
+        // 缓冲区满：先把已写好的发布出去，再等消费者腾出位置
+        if (write - pipe->head_seen == TOKEN_PIPE_CAPACITY) {
+            if (published != write) {
+                atomic_store_explicit(&pipe->tail, write, memory_order_release);
+                published = write;
+            }
+            int spins = 0;
+            while (write - (pipe->head_seen = atomic_load_explicit(&pipe->head, memory_order_acquire))
+                   == TOKEN_PIPE_CAPACITY) {
+                if (atomic_load_explicit(&pipe->stop, memory_order_relaxed)) return NULL;
+                wait_a_little(&spins);
+            }
+        }
+    
+        pipe->ring[write & (TOKEN_PIPE_CAPACITY - 1)] = token;
+        write++;
+        if (write - published >= TOKEN_PIPE_BATCH || token.type == TK_EOF) {
+            atomic_store_explicit(&pipe->tail, write, memory_order_release);
+            published = write;
+        }
+        if (token.type == TK_EOF) return NULL;
+    }
+}
+
+// 内存映射文件并启动词法分析线程
+TokenPipe* token_pipe_open(const char* filename) {
+    TokenPipe* pipe = (TokenPipe*)calloc(1, sizeof(TokenPipe));
+    if (!pipe) return NULL;
+    
+    pipe->lexer = scanner_create_from_file(filename);
+    if (pipe->lexer) {
+        pipe->view = scanner_create(pipe->lexer->source_begin,
+                                    (size_t)(pipe->lexer->source_end - pipe->lexer->source_begin));
+    }
+    if (!pipe->view) {
+        scanner_destroy(pipe->lexer);
+        free(pipe);
+        return NULL;
+    }
+    
+    atomic_init(&pipe->tail, 0);
+    atomic_init(&pipe->head, 0);
+    atomic_init(&pipe->stop, 0);
+    if (pthread_create(&pipe->thread, NULL, lex_thread, pipe) != 0) {
+        scanner_destroy(pipe->view);
+        scanner_destroy(pipe->lexer);
+        free(pipe);
+        return NULL;
+    }
+    return pipe;
+}
+
+// 取下一个Token
+Token token_pipe_next(TokenPipe* pipe) {
+    if (pipe->read > 0 && pipe->last.type == TK_EOF) return pipe->last;
+    
+    if (pipe->read == pipe->tail_seen) {
+        // 取完了已知的部分：把腾出的位置还给生产者，再等新的一批
+        atomic_store_explicit(&pipe->head, pipe->read, memory_order_release);
+        int spins = 0;
+        while ((pipe->tail_seen = atomic_load_explicit(&pipe->tail, memory_order_acquire)) == pipe->read) {
+            wait_a_little(&spins);
+        }
+    }
+    
+    pipe->last = pipe->ring[pipe->read & (TOKEN_PIPE_CAPACITY - 1)];
+    pipe->read++;
+    if (pipe->read % TOKEN_PIPE_BATCH == 0) {
+        atomic_store_explicit(&pipe->head, pipe->read, memory_order_release);
+    }
+    return pipe->last;
+}
+
+// 取Token文本和行列号用的扫描器
+Scanner* token_pipe_scanner(TokenPipe* pipe) {
+    return pipe->view;
+}
+
+// 已取出的Token数
+uint32_t token_pipe_count(const TokenPipe* pipe) {
+    return pipe->read;
+}
+
+// 停止词法分析线程并释放（视图扫描器借用词法分析扫描器的映射，先释放）
+void token_pipe_close(TokenPipe* pipe) {
+    if (!pipe) return;
+    atomic_store_explicit(&pipe->stop, 1, memory_order_relaxed);
+    pthread_join(pipe->thread, NULL);
+    scanner_destroy(pipe->view);
+    scanner_destroy(pipe->lexer);
+    free(pipe);
+}
@@ -0,0 +1,30 @@
+#ifndef TOKEN_PIPE_H
+#define TOKEN_PIPE_H
+
+#include "scanner.h"
+
+// 流水线词法分析：词法分析线程把Token成批放进单生产者/单消费者的环形缓冲区，
+// 语法分析在另一个线程按顺序取出，两边在不同的核上同时运行。
+// 环形缓冲区满时词法分析线程等待，所以内存占用固定，和文件大小无关。
+
+#define TOKEN_PIPE_CAPACITY 4096    // 环形缓冲区能放的Token数（2的幂）
+#define TOKEN_PIPE_BATCH 256        // 每攒够这么多Token才通知对方一次，减少缓存行来回传递
+
+typedef struct TokenPipe TokenPipe;
+
+// 内存映射文件并启动词法分析线程，失败返回NULL
+TokenPipe* token_pipe_open(const char* filename);
+
+// 取下一个Token（没有可取的Token时等待词法分析线程；EOF之后一直返回EOF）
+Token token_pipe_next(TokenPipe* pipe);
+
+// 取Token文本和行列号用的扫描器（只在语法分析线程中使用，和词法分析线程的扫描器互不干扰）
+Scanner* token_pipe_scanner(TokenPipe* pipe);
+
+// 已取出的Token数
+uint32_t token_pipe_count(const TokenPipe* pipe);
+
+// 停止词法分析线程（可以在EOF之前调用）并释放
+void token_pipe_close(TokenPipe* pipe);
+
+#endif
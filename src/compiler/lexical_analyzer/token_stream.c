@@ -0,0 +1,440 @@
+#include "token_stream.h"
+#include "token_cache.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// 扩大并行数组
+static int grow(TokenStream* ts) {
+    uint32_t capacity = ts->capacity * 2;
+    uint8_t* kinds = (uint8_t*)realloc(ts->kinds, capacity * sizeof(uint8_t));
+    if (kinds) ts->kinds = kinds;
+    uint32_t* offsets = (uint32_t*)realloc(ts->offsets, capacity * sizeof(uint32_t));
+    if (offsets) ts->offsets = offsets;
+    uint32_t* lengths = (uint32_t*)realloc(ts->lengths, capacity * sizeof(uint32_t));
+    if (lengths) ts->lengths = lengths;
+    uint32_t* values = (uint32_t*)realloc(ts->values, capacity * sizeof(uint32_t));
+    if (values) ts->values = values;
+    
+    if (!kinds || !offsets || !lengths || !values) return 0;
+    ts->capacity = capacity;
+    return 1;
+}
+
+// 分配空的TokenStream
+static TokenStream* token_stream_alloc(uint32_t capacity, Scanner* s) {
+    TokenStream* ts = (TokenStream*)malloc(sizeof(TokenStream));
+    if (!ts) return NULL;
+    
+    ts->capacity = capacity;
+    ts->count = 0;
+    ts->scanner = s;
+    ts->cache = NULL;
+    ts->kinds = (uint8_t*)malloc(ts->capacity * sizeof(uint8_t));
+    ts->offsets = (uint32_t*)malloc(ts->capacity * sizeof(uint32_t));
+    ts->lengths = (uint32_t*)malloc(ts->capacity * sizeof(uint32_t));
+    ts->values = (uint32_t*)malloc(ts->capacity * sizeof(uint32_t));
+    if (!ts->kinds || !ts->offsets || !ts->lengths || !ts->values) {
+        ts->scanner = NULL;
+        token_stream_destroy(ts);
+        return NULL;
+    }
+    return ts;
+}
+
+// 追加一个Token
+static int push(TokenStream* ts, Token token) {
+    if (ts->count == ts->capacity && !grow(ts)) return 0;
+    ts->kinds[ts->count] = (uint8_t)token.type;
+    ts->offsets[ts->count] = token.offset;
+    ts->lengths[ts->count] = token.length;
+    ts->values[ts->count] = token.value;
+    ts->count++;
+    return 1;
+}
+
+// 用给定的扫描器分析整个缓冲区（扫描器归TokenStream所有）
+static TokenStream* tokenize_scanner(Scanner* s) {
+    if (!s) return NULL;
+    
+    // 按平均每4字节一个Token预估容量
+    TokenStream* ts = token_stream_alloc((uint32_t)((s->source_end - s->source_begin) / 4) + 16, s);
+    if (!ts) {
+        scanner_destroy(s);
+        return NULL;
+    }
+    
+    Token token;
+    do {
+        token = scanner_next_token(s);
+        if (!push(ts, token)) {
+            token_stream_destroy(ts);
+            return NULL;
+        }
+    } while (token.type != TK_EOF);
+    
+    return ts;
+}
+
+// 一次性分析调用者持有的缓冲区
+TokenStream* tokenize_all(const char* buffer, size_t length) {
+    return tokenize_scanner(scanner_create(buffer, length));
+}
+
+// 一次性分析整个文件
+TokenStream* tokenize_file(const char* filename) {
+    return tokenize_scanner(scanner_create_from_file(filename));
+}
+
+// ==================== 并行分析 ====================
+//
+// 把缓冲区切成N块，每块从块首按"不在注释和字符串中"的假设各自分析。
+// 只有注释或字符串跨过块边界时这个假设才会出错，所以合并时：
+// 前一块结束后真正的下一个Token偏移如果也出现在本块的推测结果中，
+// 从那里开始的结果一定正确（扫描器在Token之间没有其他状态）；
+// 否则从真正的位置顺序重新分析，直到偏移重新对上为止。
+
+// 每个分块的推测分析结果
+typedef struct {
+    const char* buffer;     // 整个源缓冲区
+    size_t length;
+    uint32_t begin;         // 本块负责 [begin, end) 内开始的Token
+    uint32_t end;
+    TokenStream* tokens;    // 推测结果
+    uint32_t next_offset;   // 本块之后第一个Token的偏移
+} LexChunk;
+
+// 分析一个分块（线程入口）
+static void* lex_chunk(void* arg) {
+    LexChunk* chunk = (LexChunk*)arg;
+    Scanner* s = scanner_create(chunk->buffer, chunk->length);
+    chunk->tokens = token_stream_alloc((chunk->end - chunk->begin) / 4 + 16, NULL);
+    if (!s || !chunk->tokens) {
+        scanner_destroy(s);
+        return NULL;
+    }
+    
+    scanner_seek(s, chunk->begin);
+    Token token;
+    while (1) {
+        token = scanner_next_token(s);
+        if (token.offset >= chunk->end) break;   // 属于下一块（EOF只由最后一块保存）
+        if (!push(chunk->tokens, token)) {
+            token_stream_destroy(chunk->tokens);
+            chunk->tokens = NULL;
+            break;
+        }
+        if (token.type == TK_EOF) break;
+    }
+    chunk->next_offset = token.offset;
+    
+    scanner_destroy(s);
+    return NULL;
+}
+
+// 在推测结果中查找偏移为offset的Token（偏移严格递增，二分查找）
+static int find_offset(const TokenStream* ts, uint32_t offset, uint32_t* index) {
+    uint32_t lo = 0, hi = ts->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (ts->offsets[mid] < offset) lo = mid + 1;
+        else hi = mid;
+    }
+    *index = lo;
+    return lo < ts->count && ts->offsets[lo] == offset;
+}
+
+// 把推测结果中从from开始的Token追加到结果中
+static int append_from(TokenStream* ts, const TokenStream* src, uint32_t from) {
+    for (uint32_t i = from; i < src->count; i++) {
+        if (ts->count == ts->capacity && !grow(ts)) return 0;
+        ts->kinds[ts->count] = src->kinds[i];
+        ts->offsets[ts->count] = src->offsets[i];
+        ts->lengths[ts->count] = src->lengths[i];
+        ts->values[ts->count] = src->values[i];
+        ts->count++;
+    }
+    return 1;
+}
+
+// 按顺序合并各块的推测结果，推测错误的部分重新分析
+static int reconcile(TokenStream* ts, LexChunk* chunks, int count) {
+    Scanner* relex = scanner_create(chunks[0].buffer, chunks[0].length);
+    if (!relex || !append_from(ts, chunks[0].tokens, 0)) {
+        scanner_destroy(relex);
+        return 0;
+    }
+    
+    uint32_t next = chunks[0].next_offset;  // 下一个真正的Token的偏移
+    Token pending;                          // 重新分析时已读出但还未保存的Token
+    int has_pending = 0;
+    int ok = 1;
+    
+    for (int i = 1; i < count && ok; i++) {
+        const TokenStream* guess = chunks[i].tokens;
+        uint32_t index;
+        while (1) {
+            if (find_offset(guess, next, &index)) {
+                // 重新对齐，本块剩下的推测结果都正确
+                ok = append_from(ts, guess, index);
+                next = chunks[i].next_offset;
+                has_pending = 0;
+                break;
+            }
+            if (next >= chunks[i].end) break;   // 整块都在前面的注释或字符串里
+            
+            if (!has_pending) {
+                scanner_seek(relex, next);
+                pending = scanner_next_token(relex);
+                has_pending = 1;
+            }
+            if (!push(ts, pending)) {
+                ok = 0;
+                break;
+            }
+            if (pending.type == TK_EOF) {
+                i = count;
+                break;
+            }
+            pending = scanner_next_token(relex);
+            next = pending.offset;
+        }
+    }
+    
+    scanner_destroy(relex);
+    return ok;
+}
+
+// 在线CPU核数
+static int cpu_count() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+// 用给定的扫描器并行分析整个缓冲区（扫描器归TokenStream所有）
+TokenStream* tokenize_scanner_parallel(Scanner* s, int threads) {
+    if (!s) return NULL;
+    
+    const char* buffer = s->source_begin;
+    size_t length = (size_t)(s->source_end - s->source_begin);
+    if (threads <= 0) threads = cpu_count();
+    if ((size_t)threads > length / PARALLEL_MIN_CHUNK) threads = (int)(length / PARALLEL_MIN_CHUNK);
+    if (threads <= 1 || length >= UINT32_MAX) return tokenize_scanner(s);
+    
+    LexChunk* chunks = (LexChunk*)calloc((size_t)threads, sizeof(LexChunk));
+    pthread_t* workers = (pthread_t*)malloc((size_t)threads * sizeof(pthread_t));
+    if (!chunks || !workers) {
+        free(chunks);
+        free(workers);
+        return tokenize_scanner(s);
+    }
+    
+    // 块边界尽量放在换行符之后，那里最可能是Token之间
+    for (int i = 0; i < threads; i++) {
+        size_t begin = length / (size_t)threads * (size_t)i;
+        if (i > 0) {
+            size_t window = length - begin < PARALLEL_BOUNDARY_SEARCH ? length - begin : PARALLEL_BOUNDARY_SEARCH;
+            const char* newline = memchr(buffer + begin, '\n', window);
+            if (newline) begin = (size_t)(newline + 1 - buffer);
+        }
+        chunks[i].buffer = buffer;
+        chunks[i].length = length;
+        chunks[i].begin = (uint32_t)begin;
+        if (i > 0) chunks[i - 1].end = (uint32_t)begin;
+    }
+    chunks[threads - 1].end = UINT32_MAX;
+    
+    // 第0块在当前线程分析
+    int started = 1;
+    for (; started < threads; started++) {
+        if (pthread_create(&workers[started], NULL, lex_chunk, &chunks[started]) != 0) break;
+    }
+    lex_chunk(&chunks[0]);
+    for (int i = 1; i < started; i++) pthread_join(workers[i], NULL);
+    for (int i = started; i < threads; i++) lex_chunk(&chunks[i]);  // 线程创建失败时顺序补上
+    
+    int ok = 1;
+    for (int i = 0; i < threads; i++) {
+        if (!chunks[i].tokens) ok = 0;
+    }
+    
+    TokenStream* ts = NULL;
+    if (ok) {
+        uint32_t total = 16;
+        for (int i = 0; i < threads; i++) total += chunks[i].tokens->count;
+        ts = token_stream_alloc(total, s);
+        if (ts && !reconcile(ts, chunks, threads)) {
+            token_stream_destroy(ts);
+            ts = NULL;
+        }
+    }
+    if (!ts) scanner_destroy(s);
+    
+    for (int i = 0; i < threads; i++) token_stream_destroy(chunks[i].tokens);
+    free(chunks);
+    free(workers);
+    return ts;
+}
+
+// 并行分析调用者持有的缓冲区
+TokenStream* tokenize_all_parallel(const char* buffer, size_t length, int threads) {
+    return tokenize_scanner_parallel(scanner_create(buffer, length), threads);
+}
+
+// 并行分析整个文件
+TokenStream* tokenize_file_parallel(const char* filename, int threads) {
+    return tokenize_scanner_parallel(scanner_create_from_file(filename), threads);
+}
+
+// ==================== 增量分析 ====================
+
+// 从缓存加载的kinds和lengths是只读映射，修改前复制一份
+static int detach_cache(TokenStream* ts) {
+    if (!ts->cache) return 1;
+    
+    uint8_t* kinds = (uint8_t*)malloc(ts->capacity * sizeof(uint8_t));
+    uint32_t* lengths = (uint32_t*)malloc(ts->capacity * sizeof(uint32_t));
+    if (!kinds || !lengths) {
+        free(kinds);
+        free(lengths);
+        return 0;
+    }
+    memcpy(kinds, ts->kinds, ts->count * sizeof(uint8_t));
+    memcpy(lengths, ts->lengths, ts->count * sizeof(uint32_t));
+    ts->kinds = kinds;
+    ts->lengths = lengths;
+    token_cache_close(ts->cache);
+    ts->cache = NULL;
+    return 1;
+}
+
+// 确保容量至少为need
+static int reserve(TokenStream* ts, uint32_t need) {
+    while (ts->capacity < need) {
+        if (!grow(ts)) return 0;
+    }
+    return 1;
+}
+
+// 修改源文本后增量更新Token序列
+// 扫描器确定一个Token的结束时只多看一个字符（UTF-8编码最多4个字节；未结束的字符串除外，见下），
+// 所以结束位置在修改位置4个字节之前的Token不受影响，从最后一个这样的Token之后重新分析；
+// 新Token一旦落在修改范围之后，并且旧序列在对应位置也有Token，后面的结果就和旧的一样，只需平移偏移。
+int token_stream_edit(TokenStream* ts, TextEdit edit) {
+    Scanner* s = ts->scanner;
+    if (!detach_cache(ts)) return 0;
+    if (!scanner_replace(s, edit.offset, edit.removed, edit.inserted, edit.inserted_length)) return 0;
+    
+    int64_t delta = (int64_t)edit.inserted_length - (int64_t)edit.removed;
+    uint32_t edit_end = edit.offset + edit.inserted_length;     // 修改范围在新文本中的结束位置
+    
+    // 第一个受影响的Token：结束位置加上多看的字符到达修改位置（Token结束位置递增，二分查找）
+    uint32_t lo = 0, hi = ts->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((uint64_t)ts->offsets[mid] + ts->lengths[mid] + 3 < edit.offset) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t first = lo;
+    
+    // 未结束的字符串是一直找到文件末尾才确定的，修改可能让它结束，要从第一个这样的Token重新分析
+    // （ERROR很少见，在kinds中用memchr找，代价远小于重新分析）
+    const uint8_t* kind = ts->kinds;
+    while ((kind = memchr(kind, TK_ERROR, (size_t)(ts->kinds + first - kind))) != NULL) {
+        uint32_t index = (uint32_t)(kind - ts->kinds);
+        if (ts->values[index] == LEX_ERR_UNTERMINATED_STRING) {
+            first = index;
+            break;
+        }
+        kind++;
+    }
+    scanner_seek(s, first > 0 ? ts->offsets[first - 1] + ts->lengths[first - 1] : 0);
+    
+    // 重新分析直到和旧序列对齐（EOF总能对齐）
+    TokenStream* fresh = token_stream_alloc(16, NULL);
+    if (!fresh) return 0;
+    uint32_t resume;
+    while (1) {
+        Token token = scanner_next_token(s);
+        if (token.offset >= edit_end &&
+            find_offset(ts, (uint32_t)((int64_t)token.offset - delta), &resume)) {
+            break;
+        }
+        if (!push(fresh, token)) {
+            token_stream_destroy(fresh);
+            return 0;
+        }
+    }
+    
+    // 用新Token替换[first, resume)，后面的Token整体移动并平移偏移
+    uint32_t tail = ts->count - resume;
+    uint32_t moved_to = first + fresh->count;
+    if (!reserve(ts, moved_to + tail)) {
+        token_stream_destroy(fresh);
+        return 0;
+    }
+    memmove(ts->kinds + moved_to, ts->kinds + resume, tail * sizeof(uint8_t));
+    memmove(ts->offsets + moved_to, ts->offsets + resume, tail * sizeof(uint32_t));
+    memmove(ts->lengths + moved_to, ts->lengths + resume, tail * sizeof(uint32_t));
+    memmove(ts->values + moved_to, ts->values + resume, tail * sizeof(uint32_t));
+    for (uint32_t i = moved_to; i < moved_to + tail; i++) {
+        ts->offsets[i] = (uint32_t)((int64_t)ts->offsets[i] + delta);
+    }
+    
+    memcpy(ts->kinds + first, fresh->kinds, fresh->count * sizeof(uint8_t));
+    memcpy(ts->offsets + first, fresh->offsets, fresh->count * sizeof(uint32_t));
+    memcpy(ts->lengths + first, fresh->lengths, fresh->count * sizeof(uint32_t));
+    memcpy(ts->values + first, fresh->values, fresh->count * sizeof(uint32_t));
+    ts->count = moved_to + tail;
+    
+    token_stream_destroy(fresh);
+    return 1;
+}
+
+// 释放TokenStream
+void token_stream_destroy(TokenStream* ts) {
+    if (!ts) return;
+    if (ts->cache) {
+        token_cache_close(ts->cache);
+    } else {
+        free(ts->kinds);
+        free(ts->lengths);
+    }
+    free(ts->offsets);
+    free(ts->values);
+    scanner_destroy(ts->scanner);
+    free(ts);
+}
+
+// 取第index个Token（超出范围时返回最后的EOF）
+Token token_stream_get(const TokenStream* ts, uint32_t index) {
+    if (index >= ts->count) index = ts->count - 1;
+    
+    Token token;
+    token.type = (TokenType)ts->kinds[index];
+    token.offset = ts->offsets[index];
+    token.length = ts->lengths[index];
+    token.value = ts->values[index];
+    return token;
+}
+
+// 取第index个Token的文本
+const char* token_stream_text(const TokenStream* ts, uint32_t index, char* buffer, size_t size) {
+    return scanner_token_text(ts->scanner, token_stream_get(ts, index), buffer, size);
+}
+
+// 取第index个Token的行号列号
+void token_stream_position(const TokenStream* ts, uint32_t index, int* line, int* column) {
+    scanner_token_position(ts->scanner, token_stream_get(ts, index), line, column);
+}
@@ -0,0 +1,49 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include "scanner.h"
+
+// 整个文件一次性词法分析的结果（按字段分开存放的并行数组）
+// 第i个Token由 kinds[i]、offsets[i]、lengths[i]、values[i] 组成，最后一个总是TK_EOF
+typedef struct {
+    uint8_t* kinds;         // Token类型
+    uint32_t* offsets;      // 在源缓冲区中的字节偏移
+    uint32_t* lengths;      // 字节长度
+    uint32_t* values;       // 附加值（同Token.value）
+    uint32_t count;         // Token数量（含EOF）
+    uint32_t capacity;      // 已分配的容量
+    Scanner* scanner;       // 源缓冲区，用于按需取文本和行列号
+    struct TokenCache* cache;   // 从缓存文件加载时kinds和lengths指向映射的文件（token_cache.h），否则为NULL
+} TokenStream;
+
+// 一次性词法分析
+TokenStream* tokenize_all(const char* buffer, size_t length);   // 调用者持有的缓冲区
+TokenStream* tokenize_file(const char* filename);                // 内存映射整个文件
+void token_stream_destroy(TokenStream* ts);
+
+// 并行词法分析：切成threads块同时分析后合并（threads<=0时使用全部CPU核），
+// 结果与顺序分析相同（驻留编号和字面量编号的分配顺序可能不同）；每块不足PARALLEL_MIN_CHUNK字节时减少分块数
+#define PARALLEL_MIN_CHUNK (256 * 1024)
+#define PARALLEL_BOUNDARY_SEARCH 4096   // 在块边界之后找换行符的最大距离
+TokenStream* tokenize_all_parallel(const char* buffer, size_t length, int threads);
+TokenStream* tokenize_file_parallel(const char* filename, int threads);
+TokenStream* tokenize_scanner_parallel(Scanner* s, int threads);   // 分析给定的扫描器（扫描器归TokenStream所有）
+
+// 一次文本修改：把offset开始的removed个字节换成inserted
+typedef struct {
+    uint32_t offset;            // 修改前文本中的字节偏移
+    uint32_t removed;           // 删除的字节数
+    const char* inserted;       // 插入的文本
+    uint32_t inserted_length;
+} TextEdit;
+
+// 增量词法分析：修改源文本，只重新分析受影响的Token，之后的Token平移偏移
+// 失败返回0（修改越界或流式来源时ts不变；内存不足时ts应丢弃）
+int token_stream_edit(TokenStream* ts, TextEdit edit);
+
+// 按下标访问
+Token token_stream_get(const TokenStream* ts, uint32_t index);
+const char* token_stream_text(const TokenStream* ts, uint32_t index, char* buffer, size_t size);
+void token_stream_position(const TokenStream* ts, uint32_t index, int* line, int* column);
+
+#endif
@@ -0,0 +1,59 @@
+// 由 gen_lexer.c 根据 tokens.spec 生成，请勿手工修改
+#ifndef TOKEN_TYPES_H
+#define TOKEN_TYPES_H
+
+// Token类型枚举
+typedef enum {
+    // 关键字
+    TK_BEGIN = 1,   // begin
+    TK_END,         // end
+    TK_IF,          // if
+    TK_THEN,        // then
+    TK_ELSE,        // else
+    TK_WHILE,       // while
+    TK_DO,          // do
+    TK_FOR,         // for
+    TK_SWITCH,      // switch
+    TK_CASE,        // case
+    TK_DEFAULT,     // default
+    TK_TRUE,        // true
+    TK_FALSE,       // false
+    
+    // 标识符和常量
+    TK_ID,          // 标识符
+    TK_NUM,         // 数字常量
+    TK_STR,         // 字符串常量
+    
+    // 运算符
+    TK_PLUS,        // +
+    TK_MINUS,       // -
+    TK_MUL,         // *
+    TK_DIV,         // /
+    TK_ASSIGN,      // = (赋值)
+    TK_EQ,          // == (等于)
+    TK_NE,          // != (不等于)
+    TK_LT,          // < (小于)
+    TK_LE,          // <= (小于等于)
+    TK_GT,          // > (大于)
+    TK_GE,          // >= (大于等于)
+    
+    // 分隔符
+    TK_LPAREN,      // (
+    TK_RPAREN,      // )
+    TK_LBRACE,      // {
+    TK_RBRACE,      // }
+    TK_SEMICOLON,   // ;
+    TK_COMMA,       // ,
+    TK_COLON,       // :
+    
+    // 特殊
+    TK_EOF,         // 文件结束
+    TK_ERROR        // 错误
+} TokenType;
+
+#define TOKEN_TYPE_COUNT 37   // 最大的类型编号加1
+
+// 生成的Token类型、DFA表和关键字表的哈希（Token缓存用它判断扫描器是否重新生成过）
+#define LEXER_TABLES_HASH 0xF75FAE40u
+
+#endif
@@ -0,0 +1,66 @@
+# 词法规则：gen_lexer 由此生成 token_types.h、lexer_tables.h 和 keyword_hash.h
+# 用法: gen_lexer tokens.spec
+#
+# 每行一个Token类型，按出现顺序从1开始编号:
+#     类型名  显示名  规则  [// 说明]
+# 规则有三种:
+#     /正则/    由DFA识别；最长匹配，同样长时写在前面的规则优先
+#     "单词"    关键字：先按TK_ID识别，再查完美哈希表
+#     -         不由DFA识别，扫描器直接产生
+# 正则按字节匹配，支持: 普通字符、\转义（\n \t \r \v \f 及其他字符本身）、
+#     [...] 和 [^...] 字符集（可以写a-z这样的范围）、. （任意字节）、( )、|、*、+、?
+# 以 ## 开头的行是分组标题，原样写进生成的枚举；其他以 # 开头的行是注释
+# %skip [...] 给出Token之间的空白字符（扫描器用批量内核跳过，这里只用来区分非法字符）
+#
+# 扫描器的约定:
+#     TK_ID只能接受ASCII字符（非ASCII字符由扫描器按Unicode标识符属性处理），TK_ID的剩余部分用批量内核查找
+#     停在TK_STR的未完成状态时报"字符串未结束"，其他未完成状态报非法字符
+#     规则不能要求回退：经过接受状态之后不能再进入非接受状态（生成器会检查）
+
+%skip [ \t\n\v\f\r]
+
+## 关键字
+TK_BEGIN        BEGIN       "begin"     // begin
+TK_END          END         "end"       // end
+TK_IF           IF          "if"        // if
+TK_THEN         THEN        "then"      // then
+TK_ELSE         ELSE        "else"      // else
+TK_WHILE        WHILE       "while"     // while
+TK_DO           DO          "do"        // do
+TK_FOR          FOR         "for"       // for
+TK_SWITCH       SWITCH      "switch"    // switch
+TK_CASE         CASE        "case"      // case
+TK_DEFAULT      DEFAULT     "default"   // default
+TK_TRUE         TRUE        "true"      // true
+TK_FALSE        FALSE       "false"     // false
+
+## 标识符和常量
+TK_ID           ID          /[A-Za-z_][A-Za-z0-9_]*/    // 标识符
+TK_NUM          NUM         /[0-9]+(\.[0-9]*)?/         // 数字常量
+TK_STR          STRING      /"([^"\\]|\\.)*"/           // 字符串常量
+
+## 运算符
+TK_PLUS         PLUS        /\+/        // +
+TK_MINUS        MINUS       /-/         // -
+TK_MUL          MUL         /\*/        // *
+TK_DIV          DIV         /\//        // /
+TK_ASSIGN       ASSIGN      /=/         // = (赋值)
+TK_EQ           EQ          /==/        // == (等于)
+TK_NE           NE          /!=|<>/     // != (不等于)
+TK_LT           LT          /</         // < (小于)
+TK_LE           LE          /<=/        // <= (小于等于)
+TK_GT           GT          />/         // > (大于)
+TK_GE           GE          />=/        // >= (大于等于)
+
+## 分隔符
+TK_LPAREN       LPAREN      /\(/        // (
+TK_RPAREN       RPAREN      /\)/        // )
+TK_LBRACE       LBRACE      /\{/        // {
+TK_RBRACE       RBRACE      /\}/        // }
+TK_SEMICOLON    SEMICOLON   /;/         // ;
+TK_COMMA        COMMA       /,/         // ,
+TK_COLON        COLON       /:/         // :
+
+## 特殊
+TK_EOF          EOF         -           // 文件结束
+TK_ERROR        ERROR       -           // 错误
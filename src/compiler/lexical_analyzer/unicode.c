@@ -0,0 +1,117 @@
+#include "unicode.h"
+#include "unicode_xid.h"
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+// 解码一个字符（按Unicode标准表3-7的合法字节序列，拒绝过长编码、代理码点和超过U+10FFFF的值）
+int utf8_decode(const char* p, const char* end, uint32_t* code_point) {
+    const unsigned char* s = (const unsigned char*)p;
+    unsigned c = s[0];
+    if (c < 0x80) {
+        *code_point = c;
+        return 1;
+    }
+    
+    int length;
+    uint32_t value;
+    unsigned lo = 0x80, hi = 0xBF;  // 第二个字节的范围，后面的字节总是80..BF
+    if (c < 0xC2) {
+        return 0;
+    } else if (c < 0xE0) {
+        length = 2;
+        value = c & 0x1F;
+    } else if (c < 0xF0) {
+        length = 3;
+        value = c & 0x0F;
+        if (c == 0xE0) lo = 0xA0;
+        else if (c == 0xED) hi = 0x9F;
+    } else if (c < 0xF5) {
+        length = 4;
+        value = c & 0x07;
+        if (c == 0xF0) lo = 0x90;
+        else if (c == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    
+    for (int i = 1; i < length; i++) {
+        if (p + i >= end) return -1;
+        unsigned b = s[i];
+        if (b < lo || b > hi) return 0;
+        lo = 0x80;
+        hi = 0xBF;
+        value = (value << 6) | (b & 0x3F);
+    }
+    *code_point = value;
+    return length;
+}
+
+// 非法编码的长度：和utf8_decode走同样的检查，数出合法前缀有几个字节
+int utf8_invalid_length(const char* p, const char* end) {
+    const unsigned char* s = (const unsigned char*)p;
+    unsigned c = s[0];
+    int length;
+    unsigned lo = 0x80, hi = 0xBF;
+    if (c < 0xC2 || c >= 0xF5) return 1;
+    if (c < 0xE0) {
+        length = 2;
+    } else if (c < 0xF0) {
+        length = 3;
+        if (c == 0xE0) lo = 0xA0;
+        else if (c == 0xED) hi = 0x9F;
+    } else {
+        length = 4;
+        if (c == 0xF0) lo = 0x90;
+        else if (c == 0xF4) hi = 0x8F;
+    }
+    
+    int i = 1;
+    while (i < length && p + i < end && s[i] >= lo && s[i] <= hi) {
+        lo = 0x80;
+        hi = 0xBF;
+        i++;
+    }
+    return i;
+}
+
+// 从末尾往回找最后一个首字节（最多3个续字节），看它是否被截断
+const char* utf8_tail_start(const char* p, const char* end) {
+    const char* q = end;
+    while (q > p && end - q < 4) {
+        q--;
+        if (((unsigned char)*q & 0xC0) != 0x80) {
+            uint32_t code_point;
+            return utf8_decode(q, end, &code_point) < 0 ? q : end;
+        }
+    }
+    return end;
+}
+
+// 数字符：续字节（10xxxxxx）不计
+size_t utf8_count(const char* p, const char* end) {
+    size_t count = 0;
+    for (; p < end; p++) {
+        count += ((unsigned char)*p & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+// 在区间表中二分查找
+static int in_ranges(const UnicodeRange* ranges, size_t count, uint32_t code_point) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (code_point < ranges[mid].first) hi = mid;
+        else if (code_point > ranges[mid].last) lo = mid + 1;
+        else return 1;
+    }
+    return 0;
+}
+
+int unicode_is_xid_start(uint32_t code_point) {
+    return in_ranges(xid_start_ranges, COUNT_OF(xid_start_ranges), code_point);
+}
+
+int unicode_is_xid_continue(uint32_t code_point) {
+    return in_ranges(xid_continue_ranges, COUNT_OF(xid_continue_ranges), code_point);
+}
@@ -0,0 +1,27 @@
+#ifndef UNICODE_H
+#define UNICODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// UTF-8解码和标识符字符属性
+// 源文件按UTF-8解释；标识符按Unicode XID_Start/XID_Continue判断（表由gen_unicode_xid.py生成），
+// ASCII部分由扫描器的DFA处理，这里的函数只在遇到非ASCII字节时才调用。
+
+// 解码p处的一个字符：返回字节数（1~4）；编码非法返回0；前面合法但被end截断返回-1
+int utf8_decode(const char* p, const char* end, uint32_t* code_point);
+
+// p处非法编码的长度（最长的合法前缀，至少1字节），报错时跳过这么多字节
+int utf8_invalid_length(const char* p, const char* end);
+
+// 被end截断的最后一个字符的起始位置（没有截断时返回end）
+const char* utf8_tail_start(const char* p, const char* end);
+
+// [p, end)中的字符个数（续字节不计）
+size_t utf8_count(const char* p, const char* end);
+
+// 标识符字符属性（只用于非ASCII码点）
+int unicode_is_xid_start(uint32_t code_point);
+int unicode_is_xid_continue(uint32_t code_point);
+
+#endif
@@ -12,13 +12,16 @@ del /Q symbol_report.txt 2>nul
 del /Q error_report.txt 2>nul
 
 echo [2/3] 编译所有源文件...
+gcc -c ../lexical_analyzer/intern.c -o intern.o
+gcc -c ../lexical_analyzer/literal.c -o literal.o
+gcc -c ../grammar_analyzer/recursiveDecline/ast.c -o ast.o
 gcc -c symbol_table.c
 gcc -c type_checker.c
 gcc -c semantic.c
 gcc -c semantic_main.c
 
 echo [3/3] 链接生成可执行文件...
-gcc symbol_table.o type_checker.o semantic.o semantic_main.o -o semantic_analyzer.exe
+gcc intern.o literal.o ast.o symbol_table.o type_checker.o semantic.o semantic_main.o -o semantic_analyzer.exe -lpthread
 
 if exist semantic_analyzer.exe (
     echo 编译成功！运行语义分析器...
@@ -2,44 +2,43 @@
 #include <time.h>
 
 // 辅助函数：构建符号表
-static void build_from_node(SemanticAnalyzer* analyzer, ASTNode* node) {
-    if (!node) return;
+static void build_from_node(SemanticAnalyzer* analyzer, AstId node) {
+    if (node == AST_NONE) return;
+    const Ast* ast = analyzer->ast;
     
-    switch (node->type) {
+    switch ((NodeType)ast->kinds[node]) {
         case NODE_ASSIGNMENT: {
-            const char* var_name = node->value;
+            uint32_t var_name = ast->payloads[node].name;
             SymbolEntry* existing = lookup_symbol(analyzer->symbol_table, var_name);
             
             if (!existing) {
                 // 暂时插入为int类型，类型检查时会根据右侧表达式修正
                 insert_symbol(analyzer->symbol_table, var_name, 
-                             SYM_VARIABLE, TYPE_INT, node->line);
+                             SYM_VARIABLE, TYPE_INT, (int)ast->lines[node]);
             }
             break;
         }
             
         case NODE_ID: {
             // 确保标识符在符号表中
-            const char* var_name = node->value;
+            uint32_t var_name = ast->payloads[node].name;
             SymbolEntry* existing = lookup_symbol(analyzer->symbol_table, var_name);
             if (!existing) {
                 // 隐式声明
                 insert_symbol(analyzer->symbol_table, var_name, 
-                             SYM_VARIABLE, TYPE_INT, node->line);
+                             SYM_VARIABLE, TYPE_INT, (int)ast->lines[node]);
             }
             break;
         }
             
         default:
             // 递归处理子节点
-            build_from_node(analyzer, node->left);
-            build_from_node(analyzer, node->right);
+            build_from_node(analyzer, ast->lefts[node]);
+            build_from_node(analyzer, ast->rights[node]);
             
             // 处理兄弟节点
-            ASTNode* sibling = node->next;
-            while (sibling) {
+            for (AstId sibling = ast->nexts[node]; sibling != AST_NONE; sibling = ast->nexts[sibling]) {
                 build_from_node(analyzer, sibling);
-                sibling = sibling->next;
             }
             break;
     }
@@ -47,19 +46,20 @@ static void build_from_node(SemanticAnalyzer* analyzer, ASTNode* node) {
 
 // 构建符号表
 void build_symbol_table(SemanticAnalyzer* analyzer) {
-    if (!analyzer || !analyzer->ast_root) return;
+    if (!analyzer || analyzer->ast_root == AST_NONE) return;
     
     build_from_node(analyzer, analyzer->ast_root);
 }
 
 // 创建语义分析器
-SemanticAnalyzer* create_semantic_analyzer(ASTNode* ast) {
+SemanticAnalyzer* create_semantic_analyzer(const Ast* ast, AstId root) {
     SemanticAnalyzer* analyzer = (SemanticAnalyzer*)malloc(sizeof(SemanticAnalyzer));
     if (!analyzer) return NULL;
     
     analyzer->symbol_table = create_symbol_table();
-    init_type_checker(&analyzer->type_context, analyzer->symbol_table);
-    analyzer->ast_root = ast;
+    init_type_checker(&analyzer->type_context, analyzer->symbol_table, ast);
+    analyzer->ast = ast;
+    analyzer->ast_root = root;
     analyzer->warning_count = 0;
     
     return analyzer;
@@ -70,12 +70,15 @@ void destroy_semantic_analyzer(SemanticAnalyzer* analyzer) {
     if (!analyzer) return;
     
     destroy_symbol_table(analyzer->symbol_table);
+    free(analyzer->type_context.node_types);
+    free(analyzer->type_context.pending);
+    free(analyzer->type_context.results);
     free(analyzer);
 }
 
 // 执行语义分析
 void perform_semantic_analysis(SemanticAnalyzer* analyzer) {
-    if (!analyzer || !analyzer->ast_root) return;
+    if (!analyzer || analyzer->ast_root == AST_NONE) return;
     
     printf("Starting semantic analysis...\n");
     printf("===============================\n\n");
@@ -111,7 +114,7 @@ void check_unused_variables(SemanticAnalyzer* analyzer) {
     while (entry) {
         if (entry->sym_type == SYM_VARIABLE && !entry->used) {
             printf("Warning: Unused variable '%s' declared at line %d\n",
-                   entry->name, entry->line_number);
+                   intern_text(entry->name), entry->line_number);
             unused_count++;
             analyzer->warning_count++;
         }
@@ -144,11 +147,12 @@ void generate_symbol_report(SemanticAnalyzer* analyzer, const char* filename) {
             case TYPE_FLOAT: data_type_str = "float"; break;
             case TYPE_BOOL: data_type_str = "bool"; break;
             case TYPE_STRING: data_type_str = "string"; break;
+            case TYPE_ERROR: data_type_str = "error"; break;
             default: data_type_str = "void"; break;
         }
         
         fprintf(file, "%s: %s [Line: %d, Init: %s, Used: %s]\n",
-               entry->name, data_type_str,
+               intern_text(entry->name), data_type_str,
                entry->line_number,
                entry->initialized ? "Yes" : "No",
                entry->used ? "Yes" : "No");
@@ -7,12 +7,13 @@
 typedef struct {
     TypeCheckContext type_context;
     SymbolTable* symbol_table;
-    ASTNode* ast_root;
+    const Ast* ast;
+    AstId ast_root;
     int warning_count;
 } SemanticAnalyzer;
 
 // 函数声明
-SemanticAnalyzer* create_semantic_analyzer(ASTNode* ast);
+SemanticAnalyzer* create_semantic_analyzer(const Ast* ast, AstId root);
 void destroy_semantic_analyzer(SemanticAnalyzer* analyzer);
 void perform_semantic_analysis(SemanticAnalyzer* analyzer);
 void build_symbol_table(SemanticAnalyzer* analyzer);
@@ -1,21 +1,35 @@
 #include "semantic.h"
 #include <time.h>
 
+// 测试用的语法树
+static Ast* ast;
+
 // 创建节点函数
-ASTNode* create_node(NodeType type, const char* value, int line) {
-    ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
-    node->type = type;
-    strncpy(node->value, value, 99);
-    node->value[99] = '\0';
-    node->line = line;
-    node->column = 1;
-    node->data_type = TYPE_VOID;
-    node->left = node->right = node->next = NULL;
+static AstId create_node(NodeType type, const char* value, int line) {
+    AstId node = ast_add(ast, type, line, 1);
+    if (node == AST_NONE) return AST_NONE;
+    
+    // 名字只驻留一次，之后都按编号比较；数字解析一次放进字面量表
+    if (type == NODE_ID || type == NODE_ASSIGNMENT || type == NODE_STR) {
+        ast->payloads[node].name = intern(value, strlen(value));
+    } else if (type == NODE_NUM) {
+        NumLiteral number = { NUM_INT, { 0 } };
+        parse_number(value, strlen(value), &number);
+        ast->payloads[node].literal = literal_add(number);
+    } else if (type == NODE_BINARY_OP || type == NODE_RELOP) {
+        ast->payloads[node].op = ast_op_from_text(value);
+    }
     return node;
 }
 
+// 设置节点的孩子（先创建孩子再取数组，添加节点可能使数组搬家）
+static void set_children(AstId node, AstId left, AstId right) {
+    ast->lefts[node] = left;
+    ast->rights[node] = right;
+}
+
 // 创建正确的测试AST
-ASTNode* create_test_ast() {
+static AstId create_test_ast() {
     // 创建测试程序：
     // 1. x = 10 + 20;           // x 是 int
     // 2. y = x * 3;             // y 是 int
@@ -23,36 +37,32 @@ ASTNode* create_test_ast() {
     // 4.   z = "Greater"        // z 应该是 string 类型
     
     // 语句1: x = 10 + 20;
-    ASTNode* assign1 = create_node(NODE_ASSIGNMENT, "x", 1);
-    ASTNode* add = create_node(NODE_BINARY_OP, "+", 1);
-    add->left = create_node(NODE_NUM, "10", 1);
-    add->right = create_node(NODE_NUM, "20", 1);
-    assign1->left = add;
+    AstId assign1 = create_node(NODE_ASSIGNMENT, "x", 1);
+    AstId add = create_node(NODE_BINARY_OP, "+", 1);
+    set_children(add, create_node(NODE_NUM, "10", 1), create_node(NODE_NUM, "20", 1));
+    set_children(assign1, add, AST_NONE);
     
     // 语句2: y = x * 3;
-    ASTNode* assign2 = create_node(NODE_ASSIGNMENT, "y", 2);
-    ASTNode* mul = create_node(NODE_BINARY_OP, "*", 2);
-    mul->left = create_node(NODE_ID, "x", 2);
-    mul->right = create_node(NODE_NUM, "3", 2);
-    assign2->left = mul;
+    AstId assign2 = create_node(NODE_ASSIGNMENT, "y", 2);
+    AstId mul = create_node(NODE_BINARY_OP, "*", 2);
+    set_children(mul, create_node(NODE_ID, "x", 2), create_node(NODE_NUM, "3", 2));
+    set_children(assign2, mul, AST_NONE);
     
     // 语句3: if x > 15 then z = "Greater"
-    ASTNode* if_stmt = create_node(NODE_IF, "if", 3);
+    AstId if_stmt = create_node(NODE_IF, "if", 3);
     
     // 创建条件表达式: x > 15
-    ASTNode* gt = create_node(NODE_RELOP, ">", 3);
-    gt->left = create_node(NODE_ID, "x", 3);
-    gt->right = create_node(NODE_NUM, "15", 3);
-    if_stmt->left = gt;  // 条件作为左孩子
+    AstId gt = create_node(NODE_RELOP, ">", 3);
+    set_children(gt, create_node(NODE_ID, "x", 3), create_node(NODE_NUM, "15", 3));
     
     // then分支: z = "Greater"
-    ASTNode* then_assign = create_node(NODE_ASSIGNMENT, "z", 4);
-    then_assign->left = create_node(NODE_STR, "Greater", 4);  // 注意：去掉引号
-    if_stmt->right = then_assign;  // then语句作为右孩子
+    AstId then_assign = create_node(NODE_ASSIGNMENT, "z", 4);
+    set_children(then_assign, create_node(NODE_STR, "Greater", 4), AST_NONE);  // 注意：去掉引号
+    set_children(if_stmt, gt, then_assign);  // 条件作为左孩子，then语句作为右孩子
     
     // 连接所有语句
-    assign1->next = assign2;
-    assign2->next = if_stmt;
+    ast->nexts[assign1] = assign2;
+    ast->nexts[assign2] = if_stmt;
     
     return assign1;
 }
@@ -65,10 +75,15 @@ int main() {
     clock_t start_time = clock();
     
     printf("[1/4] Creating test AST...\n");
-    ASTNode* ast = create_test_ast();
+    ast = ast_create();
+    if (!ast) {
+        printf("Error: Out of memory\n");
+        return 1;
+    }
+    AstId root = create_test_ast();
     
     printf("[2/4] Creating semantic analyzer...\n");
-    SemanticAnalyzer* analyzer = create_semantic_analyzer(ast);
+    SemanticAnalyzer* analyzer = create_semantic_analyzer(ast, root);
     if (!analyzer) {
         printf("Error: Failed to create semantic analyzer\n");
         return 1;
@@ -90,16 +105,8 @@ int main() {
     printf("========================================\n");
     
     // 清理AST内存
-    void free_ast(ASTNode* node) {
-        if (!node) return;
-        free_ast(node->left);
-        free_ast(node->right);
-        free_ast(node->next);
-        free(node);
-    }
-    free_ast(ast);
-    
     destroy_semantic_analyzer(analyzer);
+    ast_destroy(ast);
     
     printf("\nPress Enter to exit...");
     getchar();
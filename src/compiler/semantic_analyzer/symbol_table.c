@@ -23,7 +23,7 @@ void destroy_symbol_table(SymbolTable* table) {
 }
 
 // 插入符号
-SymbolEntry* insert_symbol(SymbolTable* table, const char* name, 
+SymbolEntry* insert_symbol(SymbolTable* table, uint32_t name, 
                           SymbolType sym_type, DataType data_type, int line) {
     // 检查是否已存在
     if (lookup_symbol(table, name)) {
@@ -31,8 +31,7 @@ SymbolEntry* insert_symbol(SymbolTable* table, const char* name,
     }
     
     SymbolEntry* entry = (SymbolEntry*)malloc(sizeof(SymbolEntry));
-    strncpy(entry->name, name, MAX_NAME_LEN - 1);
-    entry->name[MAX_NAME_LEN - 1] = '\0';
+    entry->name = name;
     entry->sym_type = sym_type;
     entry->data_type = data_type;
     entry->scope_level = table->scope_level;
@@ -46,11 +45,11 @@ SymbolEntry* insert_symbol(SymbolTable* table, const char* name,
     return entry;
 }
 
-// 查找符号
-SymbolEntry* lookup_symbol(SymbolTable* table, const char* name) {
+// 查找符号（按驻留编号比较）
+SymbolEntry* lookup_symbol(SymbolTable* table, uint32_t name) {
     SymbolEntry* entry = table->symbols;
     while (entry) {
-        if (strcmp(entry->name, name) == 0) {
+        if (entry->name == name) {
             return entry;
         }
         entry = entry->next;
@@ -61,6 +60,7 @@ SymbolEntry* lookup_symbol(SymbolTable* table, const char* name) {
 // 检查类型兼容性
 bool check_type_compatibility(DataType type1, DataType type2) {
     if (type1 == type2) return true;
+    if (type1 == TYPE_ERROR || type2 == TYPE_ERROR) return true;
     
     // 允许的隐式转换
     if (type1 == TYPE_INT && type2 == TYPE_FLOAT) return true;
@@ -70,24 +70,32 @@ bool check_type_compatibility(DataType type1, DataType type2) {
 }
 
 // 获取表达式类型
-DataType get_expression_type(DataType type1, DataType type2, const char* op) {
-    // 算术运算
-    if (strcmp(op, "+") == 0 || strcmp(op, "-") == 0 || 
-        strcmp(op, "*") == 0 || strcmp(op, "/") == 0) {
-        if (type1 == TYPE_FLOAT || type2 == TYPE_FLOAT) {
-            return TYPE_FLOAT;
-        }
-        return TYPE_INT;
-    }
+DataType get_expression_type(DataType type1, DataType type2, AstOp op) {
+    if (type1 == TYPE_ERROR || type2 == TYPE_ERROR) return TYPE_ERROR;
     
-    // 关系运算
-    if (strcmp(op, "<") == 0 || strcmp(op, "<=") == 0 ||
-        strcmp(op, ">") == 0 || strcmp(op, ">=") == 0 ||
-        strcmp(op, "==") == 0 || strcmp(op, "!=") == 0) {
-        return TYPE_BOOL;
-    }
+    switch (op) {
+        // 算术运算
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+            if (type1 == TYPE_FLOAT || type2 == TYPE_FLOAT) {
+                return TYPE_FLOAT;
+            }
+            return TYPE_INT;
+    
+        // 关系运算
+        case OP_GT:
+        case OP_LT:
+        case OP_GE:
+        case OP_LE:
+        case OP_EQ:
+        case OP_NE:
+            return TYPE_BOOL;
     
-    return TYPE_VOID;
+        default:
+            return TYPE_VOID;
+    }
 }
 
 // 打印符号表
@@ -104,22 +112,23 @@ void print_symbol_table(SymbolTable* table) {
             case SYM_FUNCTION: sym_type_str = "Function"; break;
             default: sym_type_str = "Unknown"; break;
         }
-        
+    
         const char* data_type_str;
         switch (entry->data_type) {
             case TYPE_INT: data_type_str = "int"; break;
             case TYPE_FLOAT: data_type_str = "float"; break;
             case TYPE_BOOL: data_type_str = "bool"; break;
             case TYPE_STRING: data_type_str = "string"; break;
+            case TYPE_ERROR: data_type_str = "error"; break;
             default: data_type_str = "void"; break;
         }
-        
+    
         printf("%s (%s): %s [Line: %d, Init: %s, Used: %s]\n",
-               entry->name, sym_type_str, data_type_str,
+               intern_text(entry->name), sym_type_str, data_type_str,
                entry->line_number,
                entry->initialized ? "Yes" : "No",
                entry->used ? "Yes" : "No");
-        
+    
         entry = entry->next;
     }
 }
\ No newline at end of file
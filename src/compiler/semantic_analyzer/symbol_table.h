@@ -5,9 +5,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include "../lexical_analyzer/intern.h"
+#include "../grammar_analyzer/recursiveDecline/ast.h"
 
 #define MAX_SYMBOLS 1000
-#define MAX_NAME_LEN 100
 
 // 数据类型
 typedef enum {
@@ -15,7 +16,8 @@ typedef enum {
     TYPE_INT,
     TYPE_FLOAT,
     TYPE_BOOL,
-    TYPE_STRING
+    TYPE_STRING,
+    TYPE_ERROR      // 语法错误处的表达式：和任何类型兼容，不再由它引出类型错误
 } DataType;
 
 // 符号类型
@@ -27,7 +29,7 @@ typedef enum {
 
 // 符号表条目
 typedef struct SymbolEntry {
-    char name[MAX_NAME_LEN];
+    uint32_t name;              // 名字的驻留编号（intern.h）
     SymbolType sym_type;
     DataType data_type;
     int scope_level;
@@ -47,11 +49,11 @@ typedef struct {
 // 函数声明
 SymbolTable* create_symbol_table();
 void destroy_symbol_table(SymbolTable* table);
-SymbolEntry* insert_symbol(SymbolTable* table, const char* name, 
+SymbolEntry* insert_symbol(SymbolTable* table, uint32_t name, 
                           SymbolType sym_type, DataType data_type, int line);
-SymbolEntry* lookup_symbol(SymbolTable* table, const char* name);
+SymbolEntry* lookup_symbol(SymbolTable* table, uint32_t name);
 bool check_type_compatibility(DataType type1, DataType type2);
-DataType get_expression_type(DataType type1, DataType type2, const char* op);
+DataType get_expression_type(DataType type1, DataType type2, AstOp op);
 void print_symbol_table(SymbolTable* table);
 
 #endif
\ No newline at end of file
@@ -1,11 +1,25 @@
 #include "type_checker.h"
 
 // 初始化类型检查器
-void init_type_checker(TypeCheckContext* context, SymbolTable* table) {
+void init_type_checker(TypeCheckContext* context, SymbolTable* table, const Ast* ast) {
     context->symbol_table = table;
+    context->ast = ast;
+    context->node_types = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    context->pending = NULL;
+    context->pending_count = 0;
+    context->pending_capacity = 0;
+    context->results = NULL;
+    context->result_count = 0;
+    context->result_capacity = 0;
     context->error_count = 0;
 }
 
+// 记下节点推断出的类型
+static DataType set_type(TypeCheckContext* context, AstId node, DataType type) {
+    if (context->node_types) context->node_types[node] = (uint8_t)type;
+    return type;
+}
+
 // 报告语义错误
 void report_semantic_error(TypeCheckContext* context, ErrorType type, 
                           const char* message, int line, int col) {
@@ -31,7 +45,7 @@ void print_semantic_errors(TypeCheckContext* context) {
     printf("\n=== Semantic Errors (%d) ===\n", context->error_count);
     for (int i = 0; i < context->error_count; i++) {
         SemanticError* error = &context->errors[i];
-        
+    
         const char* error_type;
         switch (error->type) {
             case ERR_UNDECLARED_VAR: error_type = "Undeclared variable"; break;
@@ -40,106 +54,183 @@ void print_semantic_errors(TypeCheckContext* context) {
             case ERR_UNUSED_VAR: error_type = "Unused variable"; break;
             default: error_type = "Unknown error"; break;
         }
-        
+    
         printf("Error [%s] at line %d, col %d: %s\n",
                error_type, error->line, error->column, error->message);
     }
 }
 
-// 类型检查表达式
-DataType type_check_expression(TypeCheckContext* context, ASTNode* node) {
-    if (!node) return TYPE_VOID;
+// 扩大一个栈（失败时原数组保持不变）
+static void grow_stack(void** array, uint32_t* capacity, size_t element_size) {
+    uint32_t grown_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(*array, (size_t)grown_capacity * element_size);
+    if (!grown) {
+        printf("\n❌ 内存不足\n");
+        exit(1);
+    }
+    *array = grown;
+    *capacity = grown_capacity;
+}
+
+static void push_pending(TypeCheckContext* context, AstId node, bool children_done) {
+    if (context->pending_count == context->pending_capacity) {
+        grow_stack((void**)&context->pending, &context->pending_capacity, sizeof(PendingExpression));
+    }
+    PendingExpression* pending = &context->pending[context->pending_count++];
+    pending->node = node;
+    pending->children_done = children_done;
+}
+
+static void push_result(TypeCheckContext* context, DataType type) {
+    if (context->result_count == context->result_capacity) {
+        grow_stack((void**)&context->results, &context->result_capacity, sizeof(uint8_t));
+    }
+    context->results[context->result_count++] = (uint8_t)type;
+}
+
+// 类型检查没有子表达式的节点
+static DataType check_operand(TypeCheckContext* context, AstId node) {
+    if (node == AST_NONE) return TYPE_VOID;
+    const Ast* ast = context->ast;
+    int line = (int)ast->lines[node];
+    int column = (int)ast->columns[node];
     
-    switch (node->type) {
+    switch ((NodeType)ast->kinds[node]) {
         case NODE_ID: {
-            const char* var_name = node->value;
-            SymbolEntry* entry = lookup_symbol(context->symbol_table, var_name);
-            
+            uint32_t name = ast->payloads[node].name;
+            const char* var_name = intern_text(name);
+            SymbolEntry* entry = lookup_symbol(context->symbol_table, name);
+    
             if (!entry) {
                 char msg[256];
                 snprintf(msg, sizeof(msg), "Undeclared variable '%s'", var_name);
                 report_semantic_error(context, ERR_UNDECLARED_VAR, 
-                                     msg, node->line, node->column);
+                                     msg, line, column);
                 return TYPE_VOID;
             }
-            
+    
             entry->used = true;
-            
+    
             if (!entry->initialized && entry->sym_type == SYM_VARIABLE) {
                 char msg[256];
                 snprintf(msg, sizeof(msg), "Uninitialized variable '%s'", var_name);
                 report_semantic_error(context, ERR_UNINITIALIZED, 
-                                     msg, node->line, node->column);
+                                     msg, line, column);
             }
-            
-            node->data_type = entry->data_type;
-            return entry->data_type;
+    
+            return set_type(context, node, entry->data_type);
         }
-        
+    
         case NODE_NUM:
-            node->data_type = TYPE_INT;
-            return TYPE_INT;
-            
+            // 字面量的类型在词法分析时已经确定
+            return set_type(context, node, literal_get(ast->payloads[node].literal).kind == NUM_FLOAT
+                                           ? TYPE_FLOAT : TYPE_INT);
+    
         case NODE_STR:
-            node->data_type = TYPE_STRING;
-            return TYPE_STRING;
-            
+            return set_type(context, node, TYPE_STRING);
+    
+        case NODE_ERROR:
+            // 语法错误已经报告过
+            return set_type(context, node, TYPE_ERROR);
+    
+        default:
+            return TYPE_VOID;
+    }
+}
+
+// 类型检查运算符节点，左右子表达式已经检查过
+static DataType check_operator(TypeCheckContext* context, AstId node,
+                               DataType left_type, DataType right_type) {
+    const Ast* ast = context->ast;
+    int line = (int)ast->lines[node];
+    int column = (int)ast->columns[node];
+    
+    switch ((NodeType)ast->kinds[node]) {
         case NODE_BINARY_OP: {
-            DataType left_type = type_check_expression(context, node->left);
-            DataType right_type = type_check_expression(context, node->right);
-            
+            AstOp op = (AstOp)ast->payloads[node].op;
+    
             // 对于关系运算符，返回布尔类型
-            if (strcmp(node->value, ">") == 0 || strcmp(node->value, "<") == 0 ||
-                strcmp(node->value, ">=") == 0 || strcmp(node->value, "<=") == 0 ||
-                strcmp(node->value, "==") == 0 || strcmp(node->value, "!=") == 0) {
-                node->data_type = TYPE_BOOL;
-                return TYPE_BOOL;
+            if (ast_op_is_relational(op)) {
+                return set_type(context, node, TYPE_BOOL);
             }
-            
+    
             // 对于算术运算符，检查类型兼容性
             if (!check_type_compatibility(left_type, right_type)) {
                 char msg[256];
                 snprintf(msg, sizeof(msg), 
-                         "Type mismatch in binary operation '%s'", node->value);
+                         "Type mismatch in binary operation '%s'", ast_op_text(op));
                 report_semantic_error(context, ERR_TYPE_MISMATCH, 
-                                     msg, node->line, node->column);
+                                     msg, line, column);
                 return TYPE_VOID;
             }
-            
-            DataType result_type = get_expression_type(left_type, right_type, node->value);
-            node->data_type = result_type;
-            return result_type;
+    
+            return set_type(context, node, get_expression_type(left_type, right_type, op));
         }
-            
-        case NODE_RELOP: {
+    
+        case NODE_RELOP:
+        case NODE_CONDITION: {
             // 关系运算符：检查左右操作数都是数值类型
-            DataType left_type = type_check_expression(context, node->left);
-            DataType right_type = type_check_expression(context, node->right);
-            
-            if ((left_type != TYPE_INT && left_type != TYPE_FLOAT) ||
-                (right_type != TYPE_INT && right_type != TYPE_FLOAT)) {
+            // （语法分析器产生的条件节点的两个孩子是左右表达式，运算符是左表达式的兄弟）
+            if (left_type != TYPE_ERROR && right_type != TYPE_ERROR &&
+                ((left_type != TYPE_INT && left_type != TYPE_FLOAT) ||
+                 (right_type != TYPE_INT && right_type != TYPE_FLOAT))) {
                 char msg[256];
                 snprintf(msg, sizeof(msg), 
                          "Relational operator requires numeric operands");
                 report_semantic_error(context, ERR_TYPE_MISMATCH, 
-                                     msg, node->line, node->column);
+                                     msg, line, column);
             }
-            
-            node->data_type = TYPE_BOOL;
-            return TYPE_BOOL;
+    
+            return set_type(context, node, TYPE_BOOL);
         }
-            
+    
         default:
             return TYPE_VOID;
     }
 }
 
+static bool is_operator(const Ast* ast, AstId node) {
+    NodeType kind = (NodeType)ast->kinds[node];
+    return kind == NODE_BINARY_OP || kind == NODE_RELOP || kind == NODE_CONDITION;
+}
+
+// 类型检查表达式。用显式栈代替递归（后序遍历），很深的表达式树（如上万项的连加）不会耗尽调用栈：
+// 运算符节点第一次弹出时压回自己并压入左右孩子，孩子的类型依次进入结果栈，第二次弹出时取出左右类型
+DataType type_check_expression(TypeCheckContext* context, AstId node) {
+    if (node == AST_NONE) return TYPE_VOID;
+    const Ast* ast = context->ast;
+    uint32_t pending_base = context->pending_count;
+    
+    push_pending(context, node, false);
+    while (context->pending_count > pending_base) {
+        PendingExpression pending = context->pending[--context->pending_count];
+    
+        if (pending.node == AST_NONE || !is_operator(ast, pending.node)) {
+            push_result(context, check_operand(context, pending.node));
+        } else if (!pending.children_done) {
+            push_pending(context, pending.node, true);
+            push_pending(context, ast->rights[pending.node], false);
+            push_pending(context, ast->lefts[pending.node], false);
+        } else {
+            DataType right_type = (DataType)context->results[--context->result_count];
+            DataType left_type = (DataType)context->results[--context->result_count];
+            push_result(context, check_operator(context, pending.node, left_type, right_type));
+        }
+    }
+    
+    DataType type = (DataType)context->results[--context->result_count];
+    return type;
+}
+
 // 类型检查条件表达式
-DataType type_check_condition(TypeCheckContext* context, ASTNode* node) {
+DataType type_check_condition(TypeCheckContext* context, AstId node) {
+    if (node == AST_NONE) return TYPE_VOID;
+    int line = (int)context->ast->lines[node];
+    int column = (int)context->ast->columns[node];
     DataType cond_type = type_check_expression(context, node);
     
     // 条件必须是布尔类型
-    if (cond_type != TYPE_BOOL) {
+    if (cond_type != TYPE_BOOL && cond_type != TYPE_ERROR) {
         char msg[256];
         snprintf(msg, sizeof(msg), 
                  "Condition expression must be boolean, got %s",
@@ -147,36 +238,40 @@ DataType type_check_condition(TypeCheckContext* context, ASTNode* node) {
                  cond_type == TYPE_FLOAT ? "float" :
                  cond_type == TYPE_STRING ? "string" : "unknown");
         report_semantic_error(context, ERR_TYPE_MISMATCH, 
-                             msg, node->line, node->column);
+                             msg, line, column);
     }
     
     return cond_type;
 }
 
 // 类型检查赋值语句
-DataType type_check_assignment(TypeCheckContext* context, ASTNode* node) {
-    if (!node || node->type != NODE_ASSIGNMENT) return TYPE_VOID;
+DataType type_check_assignment(TypeCheckContext* context, AstId node) {
+    const Ast* ast = context->ast;
+    if (node == AST_NONE || ast->kinds[node] != NODE_ASSIGNMENT) return TYPE_VOID;
+    int line = (int)ast->lines[node];
+    int column = (int)ast->columns[node];
     
-    const char* var_name = node->value;
-    SymbolEntry* entry = lookup_symbol(context->symbol_table, var_name);
+    uint32_t name = ast->payloads[node].name;
+    const char* var_name = intern_text(name);
+    SymbolEntry* entry = lookup_symbol(context->symbol_table, name);
     
     if (!entry) {
         // 根据右侧表达式推断类型
-        DataType rhs_type = type_check_expression(context, node->left);
-        
+        DataType rhs_type = type_check_expression(context, ast->lefts[node]);
+    
         // 创建变量，使用右侧表达式的类型
-        entry = insert_symbol(context->symbol_table, var_name, 
-                             SYM_VARIABLE, rhs_type, node->line);
+        entry = insert_symbol(context->symbol_table, name, 
+                             SYM_VARIABLE, rhs_type, line);
         if (!entry) {
             char msg[256];
             snprintf(msg, sizeof(msg), "Cannot declare variable '%s'", var_name);
             report_semantic_error(context, ERR_UNDECLARED_VAR, 
-                                 msg, node->line, node->column);
+                                 msg, line, column);
             return TYPE_VOID;
         }
     }
     
-    DataType rhs_type = type_check_expression(context, node->left);
+    DataType rhs_type = type_check_expression(context, ast->lefts[node]);
     
     // 检查类型兼容性
     if (!check_type_compatibility(entry->data_type, rhs_type)) {
@@ -193,7 +288,7 @@ DataType type_check_assignment(TypeCheckContext* context, ASTNode* node) {
                  rhs_type == TYPE_STRING ? "string" :
                  rhs_type == TYPE_BOOL ? "bool" : "unknown");
         report_semantic_error(context, ERR_TYPE_MISMATCH, 
-                             msg, node->line, node->column);
+                             msg, line, column);
     }
     
     entry->initialized = true;
@@ -202,36 +297,50 @@ DataType type_check_assignment(TypeCheckContext* context, ASTNode* node) {
 }
 
 // 类型检查if语句
-DataType type_check_if(TypeCheckContext* context, ASTNode* node) {
-    if (!node || node->type != NODE_IF) return TYPE_VOID;
+DataType type_check_if(TypeCheckContext* context, AstId node) {
+    const Ast* ast = context->ast;
+    if (node == AST_NONE || ast->kinds[node] != NODE_IF) return TYPE_VOID;
+    
+    if (ast->payloads[node].has_else) {
+        // if-else节点：左孩子是不带else的if节点，右孩子是else分支
+        type_check_if(context, ast->lefts[node]);
+        type_check_statement(context, ast->rights[node]);
+        return TYPE_VOID;
+    }
     
     // 检查条件表达式
-    type_check_condition(context, node->left);
+    type_check_condition(context, ast->lefts[node]);
     
     // 检查then分支
-    type_check_statement(context, node->right);
+    type_check_statement(context, ast->rights[node]);
     
     return TYPE_VOID;
 }
 
 // 类型检查while语句
-DataType type_check_while(TypeCheckContext* context, ASTNode* node) {
-    if (!node || node->type != NODE_WHILE) return TYPE_VOID;
+DataType type_check_while(TypeCheckContext* context, AstId node) {
+    const Ast* ast = context->ast;
+    if (node == AST_NONE || ast->kinds[node] != NODE_WHILE) return TYPE_VOID;
     
     // 检查条件表达式
-    type_check_condition(context, node->left);
+    type_check_condition(context, ast->lefts[node]);
     
     // 检查循环体
-    type_check_statement(context, node->right);
+    type_check_statement(context, ast->rights[node]);
     
     return TYPE_VOID;
 }
 
 // 类型检查语句
-void type_check_statement(TypeCheckContext* context, ASTNode* node) {
-    if (!node) return;
+void type_check_statement(TypeCheckContext* context, AstId node) {
+    if (node == AST_NONE) return;
     
-    switch (node->type) {
+    switch ((NodeType)context->ast->kinds[node]) {
+        case NODE_PROGRAM:
+        case NODE_BLOCK:
+            // 语法分析器产生的程序和语句块：孩子是语句序列
+            type_check_program(context, context->ast->lefts[node]);
+            break;
         case NODE_ASSIGNMENT:
             type_check_assignment(context, node);
             break;
@@ -248,13 +357,9 @@ void type_check_statement(TypeCheckContext* context, ASTNode* node) {
 }
 
 // 类型检查程序
-void type_check_program(TypeCheckContext* context, ASTNode* node) {
-    if (!node) return;
-    
+void type_check_program(TypeCheckContext* context, AstId node) {
     // 检查所有语句
-    ASTNode* stmt = node;
-    while (stmt) {
+    for (AstId stmt = node; stmt != AST_NONE; stmt = context->ast->nexts[stmt]) {
         type_check_statement(context, stmt);
-        stmt = stmt->next;
     }
 }
\ No newline at end of file
@@ -2,32 +2,7 @@
 #define TYPE_CHECKER_H
 
 #include "symbol_table.h"
-
-// AST节点类型
-typedef enum {
-    NODE_ASSIGNMENT,
-    NODE_IF,
-    NODE_WHILE,
-    NODE_EXPRESSION,
-    NODE_ID,
-    NODE_NUM,
-    NODE_STR,
-    NODE_BINARY_OP,
-    NODE_RELOP,           // 关系运算符节点
-    NODE_CONDITION        // 条件节点
-} NodeType;
-
-// AST节点
-typedef struct ASTNode {
-    NodeType type;
-    char value[100];
-    DataType data_type;
-    int line;
-    int column;
-    struct ASTNode* left;
-    struct ASTNode* right;
-    struct ASTNode* next;
-} ASTNode;
+#include "../grammar_analyzer/recursiveDecline/ast.h"
 
 // 语义错误类型
 typedef enum {
@@ -45,22 +20,36 @@ typedef struct {
     int column;
 } SemanticError;
 
+// 等待检查的表达式节点（children_done为真时左右孩子的类型已在结果栈中）
+typedef struct {
+    AstId node;
+    bool children_done;
+} PendingExpression;
+
 // 类型检查上下文
 typedef struct {
     SymbolTable* symbol_table;
+    const Ast* ast;
+    uint8_t* node_types;        // 每个节点推断出的类型（DataType，按节点编号）
+    PendingExpression* pending; // 表达式检查用的节点栈和类型栈，检查之间复用
+    uint32_t pending_count;
+    uint32_t pending_capacity;
+    uint8_t* results;
+    uint32_t result_count;
+    uint32_t result_capacity;
     SemanticError errors[100];
     int error_count;
 } TypeCheckContext;
 
 // 函数声明
-void init_type_checker(TypeCheckContext* context, SymbolTable* table);
-void type_check_program(TypeCheckContext* context, ASTNode* node);
-void type_check_statement(TypeCheckContext* context, ASTNode* node);
-DataType type_check_expression(TypeCheckContext* context, ASTNode* node);
-DataType type_check_assignment(TypeCheckContext* context, ASTNode* node);
-DataType type_check_if(TypeCheckContext* context, ASTNode* node);
-DataType type_check_while(TypeCheckContext* context, ASTNode* node);
-DataType type_check_condition(TypeCheckContext* context, ASTNode* node);
+void init_type_checker(TypeCheckContext* context, SymbolTable* table, const Ast* ast);
+void type_check_program(TypeCheckContext* context, AstId node);
+void type_check_statement(TypeCheckContext* context, AstId node);
+DataType type_check_expression(TypeCheckContext* context, AstId node);
+DataType type_check_assignment(TypeCheckContext* context, AstId node);
+DataType type_check_if(TypeCheckContext* context, AstId node);
+DataType type_check_while(TypeCheckContext* context, AstId node);
+DataType type_check_condition(TypeCheckContext* context, AstId node);
 void report_semantic_error(TypeCheckContext* context, ErrorType type, 
                           const char* message, int line, int col);
 void print_semantic_errors(TypeCheckContext* context);